@@ -0,0 +1,103 @@
+#include <stdio.h>
+#include <zephyr/kernel.h>
+
+#include "filter.h"
+#include "bench.h"
+
+// Benchmark settings
+#define BENCH_LEN 1024          // Samples per buffer
+#define BENCH_ITERATIONS 200    // Buffers per filter
+#define ADC_FULL_SCALE 4095     // Simulated 12-bit ADC
+
+// Filter settings (match 05_solution_pwm_knob)
+#define MEDIAN_LEN 5
+#define IIR_SHIFT 3
+#define CIC_ORDER 3
+#define CIC_DECIMATION 16
+
+// Buffers (static so they do not sit on the main stack)
+static uint16_t input[BENCH_LEN];
+static uint16_t output[BENCH_LEN];
+
+// Fill the input buffer with a slow ramp plus noise and occasional spikes
+static void make_input(void)
+{
+    uint32_t rnd = 0x12345678;
+
+    for (int i = 0; i < BENCH_LEN; i++) {
+
+        // xorshift32 keeps the data identical between runs
+        rnd ^= rnd << 13;
+        rnd ^= rnd >> 17;
+        rnd ^= rnd << 5;
+
+        input[i] = (uint16_t)(i * ADC_FULL_SCALE / BENCH_LEN);
+        input[i] += rnd & 0x1F;
+        if ((rnd >> 24) == 0) {
+            input[i] = ADC_FULL_SCALE;
+        }
+    }
+}
+
+// Print cycles per sample with three decimal places
+static void report(const char *name, uint64_t cycles)
+{
+    const uint64_t samples = (uint64_t)BENCH_LEN * BENCH_ITERATIONS;
+    const uint64_t milli = (cycles * 1000) / samples;
+
+    printk("%-12s %6u.%03u cycles/sample\r\n",
+           name,
+           (uint32_t)(milli / 1000),
+           (uint32_t)(milli % 1000));
+}
+
+int main(void)
+{
+    struct filter_median median;
+    struct filter_iir iir;
+    struct filter_cic cic;
+    uint64_t start;
+    uint64_t cycles;
+    size_t n_out = 0;
+
+    printk("Filter benchmark: %u samples x %u buffers\r\n",
+           BENCH_LEN,
+           BENCH_ITERATIONS);
+    printk("Counter frequency: %u Hz\r\n", (uint32_t)bench_cycles_hz());
+
+    make_input();
+
+    // Median-of-N
+    filter_median_init(&median, MEDIAN_LEN, 0);
+    start = bench_cycles_get();
+    for (int i = 0; i < BENCH_ITERATIONS; i++) {
+        filter_median_process(&median, input, output, BENCH_LEN);
+    }
+    cycles = bench_cycles_get() - start;
+    report("median5", cycles);
+
+    // Single-pole IIR
+    filter_iir_init(&iir, IIR_SHIFT);
+    start = bench_cycles_get();
+    for (int i = 0; i < BENCH_ITERATIONS; i++) {
+        filter_iir_process(&iir, input, output, BENCH_LEN);
+    }
+    cycles = bench_cycles_get() - start;
+    report("iir", cycles);
+
+    // CIC decimator (cost is per input sample)
+    filter_cic_init(&cic, CIC_ORDER, CIC_DECIMATION);
+    start = bench_cycles_get();
+    for (int i = 0; i < BENCH_ITERATIONS; i++) {
+        n_out += filter_cic_process(&cic, input, output, BENCH_LEN);
+    }
+    cycles = bench_cycles_get() - start;
+    report("cic3/16", cycles);
+
+    // Touch the outputs so the work cannot be optimized away
+    printk("Last outputs: %u (%u decimated samples)\r\n",
+           output[0],
+           (uint32_t)n_out);
+
+    return 0;
+}
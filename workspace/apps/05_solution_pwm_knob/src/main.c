@@ -3,21 +3,51 @@
 #include <zephyr/drivers/pwm.h>
 #include <zephyr/drivers/adc.h>
 
+#include "filter.h"
+
 // Settings
 static const int32_t sleep_time_ms = 10;
 
+// Filter settings
+#define ADC_BLOCK_LEN 8			// Samples taken back-to-back per loop
+#define MEDIAN_LEN 5			// Reject single-sample spikes
+#define IIR_SHIFT 3				// Smooth over ~8 samples
+
 // Get Devicetree configurations
 #define MY_ADC_CH DT_ALIAS(my_adc_channel)
 static const struct device *adc = DEVICE_DT_GET(DT_ALIAS(my_adc));
 static const struct adc_channel_cfg adc_ch = ADC_CHANNEL_CFG_DT(MY_ADC_CH);
 static const struct pwm_dt_spec pwm_led = PWM_DT_SPEC_GET(DT_ALIAS(led_0));
 
+// Median of a block, for seeding the filters (sorts a copy)
+static uint16_t block_median(const uint16_t *block, int len)
+{
+	uint16_t sorted[ADC_BLOCK_LEN];
+	uint16_t v;
+	int j;
+
+	for (int i = 0; i < len; i++) {
+		v = block[i];
+		for (j = i; (j > 0) && (sorted[j - 1] > v); j--) {
+			sorted[j] = sorted[j - 1];
+		}
+		sorted[j] = v;
+	}
+
+	return sorted[len / 2];
+}
+
 int main(void)
 {
 	int ret;
 	uint16_t buf;
+	uint16_t block[ADC_BLOCK_LEN];
+	uint16_t val;
 	int32_t vref_mv;
 	uint32_t pulse_ns;
+	struct filter_median median;
+	struct filter_iir iir;
+	bool seeded = false;
 
 	// Get Vref (mV) from Devicetree property
 	vref_mv = DT_PROP(MY_ADC_CH, zephyr_vref_mv);
@@ -52,15 +82,35 @@ int main(void)
 	// Do forever
 	while (1) {
 
-		// Sample ADC
-		ret = adc_read(adc, &seq);
+		// Sample a block of ADC readings
+		for (int i = 0; i < ADC_BLOCK_LEN; i++) {
+			ret = adc_read(adc, &seq);
+			if (ret < 0) {
+				break;
+			}
+			block[i] = buf;
+		}
 		if (ret < 0) {
 			printk("Could not read ADC: %d\r\n", ret);
 			continue;
 		}
 
+		// Initialize the filters (median feeds the IIR) from the first
+		// block, so the LED starts at the knob position instead of ramping
+		// up from 0. The IIR starts from its first input, the seed.
+		if (!seeded) {
+			filter_median_init(&median, MEDIAN_LEN, block_median(block, ADC_BLOCK_LEN));
+			filter_iir_init(&iir, IIR_SHIFT);
+			seeded = true;
+		}
+
+		// Filter the whole block in place and use the newest output
+		filter_median_process(&median, block, block, ADC_BLOCK_LEN);
+		filter_iir_process(&iir, block, block, ADC_BLOCK_LEN);
+		val = block[ADC_BLOCK_LEN - 1];
+
 		// Calculate pulse width
-		pulse_ns = pwm_led.period / ((1 << seq.resolution) / (float)buf);
+		pulse_ns = pwm_led.period / ((1 << seq.resolution) / (float)val);
 		printk("Pulse: %u ns\r\n", pulse_ns);
 
 		// Set LED PWM pulse width
@@ -0,0 +1,330 @@
+#include <stdio.h>
+#include <zephyr/kernel.h>
+#include <zephyr/drivers/counter.h>
+#include <zephyr/drivers/gpio.h>
+#ifdef CONFIG_GPIO_EMUL
+#include <zephyr/drivers/gpio/gpio_emul.h>
+#endif
+
+#include "bench.h"
+
+// Expected and actual expiry are both taken from the 64-bit cycle counter
+BUILD_ASSERT(IS_ENABLED(CONFIG_TIMER_HAS_64BIT_CYCLE_COUNTER),
+             "This benchmark needs k_cycle_get_64()");
+
+// Optional latency sources (enabled by Devicetree aliases, see boards/)
+#define HAS_COUNTER DT_NODE_EXISTS(DT_ALIAS(my_counter))
+#define HAS_GPIO_IN DT_NODE_EXISTS(DT_ALIAS(my_gpio_in))
+#define HAS_GPIO_OUT DT_NODE_EXISTS(DT_ALIAS(my_gpio_out))
+
+// Settings
+#define ALARM_CH_ID 0
+#define LOAD_STACK_SIZE 1024
+#define NUM_LOAD_STACKS MAX(CONFIG_LATENCY_LOAD_THREADS, 1)
+
+// Current measurement (only one source runs at a time)
+static struct bench_hist hist;
+static volatile uint32_t samples_left;
+static K_SEM_DEFINE(done_sem, 0, 1);
+
+// Background load threads
+K_THREAD_STACK_ARRAY_DEFINE(load_stacks, NUM_LOAD_STACKS, LOAD_STACK_SIZE);
+static struct k_thread load_threads[NUM_LOAD_STACKS];
+
+//------------------------------------------------------------------------------
+// Common
+
+// Record one sample, returns true if more samples are wanted
+static bool record(uint64_t expected_cyc, uint64_t actual_cyc)
+{
+    uint64_t late_cyc = (actual_cyc > expected_cyc) ? actual_cyc - expected_cyc : 0;
+    uint64_t late_ns = k_cyc_to_ns_floor64(late_cyc);
+
+    bench_hist_add(&hist, (uint32_t)MIN(late_ns, UINT32_MAX));
+
+    samples_left--;
+    if (samples_left == 0) {
+        k_sem_give(&done_sem);
+        return false;
+    }
+
+    return true;
+}
+
+// Reset the histogram for a new source
+static void measurement_start(void)
+{
+    bench_hist_init(&hist, CONFIG_LATENCY_BUCKET_NS);
+    samples_left = CONFIG_LATENCY_SAMPLES;
+    k_sem_reset(&done_sem);
+}
+
+// Background load: busy work (optionally with interrupts locked), then sleep
+static void load_thread_start(void *arg1, void *arg2, void *arg3)
+{
+    unsigned int key;
+
+    while (1) {
+        if (CONFIG_LATENCY_LOAD_IRQ_LOCK_US > 0) {
+            key = irq_lock();
+            k_busy_wait(CONFIG_LATENCY_LOAD_IRQ_LOCK_US);
+            irq_unlock(key);
+        }
+        if (CONFIG_LATENCY_LOAD_BUSY_US > CONFIG_LATENCY_LOAD_IRQ_LOCK_US) {
+            k_busy_wait(CONFIG_LATENCY_LOAD_BUSY_US -
+                        CONFIG_LATENCY_LOAD_IRQ_LOCK_US);
+        }
+        k_msleep(CONFIG_LATENCY_LOAD_SLEEP_MS);
+    }
+}
+
+//------------------------------------------------------------------------------
+// k_timer
+
+static struct k_timer lat_timer;
+static uint64_t timer_next_tick;
+static uint64_t timer_period_ticks;
+
+// Timer callback (ISR). The system timer counts cycles from boot, so tick T
+// is due at cycle T * cycles-per-tick.
+static void timer_expiry(struct k_timer *timer)
+{
+    uint64_t now = k_cycle_get_64();
+
+    if (record(k_ticks_to_cyc_floor64(timer_next_tick), now)) {
+
+        // Absolute re-arm: the next deadline does not depend on this latency
+        timer_next_tick += timer_period_ticks;
+        k_timer_start(timer, K_TIMEOUT_ABS_TICKS(timer_next_tick), K_NO_WAIT);
+    }
+}
+
+static void measure_k_timer(void)
+{
+    measurement_start();
+
+    k_timer_init(&lat_timer, timer_expiry, NULL);
+    timer_period_ticks = MAX(k_us_to_ticks_ceil64(CONFIG_LATENCY_PERIOD_US), 1);
+    timer_next_tick = k_uptime_ticks() + timer_period_ticks;
+    k_timer_start(&lat_timer, K_TIMEOUT_ABS_TICKS(timer_next_tick), K_NO_WAIT);
+
+    k_sem_take(&done_sem, K_FOREVER);
+    bench_hist_print(&hist, "k_timer", "ns");
+}
+
+//------------------------------------------------------------------------------
+// Counter alarm
+
+#if HAS_COUNTER
+
+static const struct device *counter_dev = DEVICE_DT_GET(DT_ALIAS(my_counter));
+static struct counter_alarm_cfg alarm_cfg;
+static uint64_t alarm_expected;
+
+// Arm a relative alarm and note when it should fire in cycle time. The
+// counter's own tick quantization shows up as up to one counter tick.
+static void counter_arm(void)
+{
+    uint32_t delay_ticks = counter_us_to_ticks(counter_dev,
+                                               CONFIG_LATENCY_PERIOD_US);
+    uint64_t delay_us = counter_ticks_to_us(counter_dev, delay_ticks);
+    unsigned int key = irq_lock();
+    int ret;
+
+    alarm_expected = k_cycle_get_64() + k_us_to_cyc_floor64(delay_us);
+    alarm_cfg.ticks = delay_ticks;
+    ret = counter_set_channel_alarm(counter_dev, ALARM_CH_ID, &alarm_cfg);
+
+    irq_unlock(key);
+
+    if (ret < 0) {
+        printk("Error (%d): could not set counter alarm\r\n", ret);
+        samples_left = 1;
+        k_sem_give(&done_sem);
+    }
+}
+
+// Counter callback (ISR)
+static void counter_isr(const struct device *dev,
+                        uint8_t chan_id,
+                        uint32_t ticks,
+                        void *user_data)
+{
+    uint64_t now = k_cycle_get_64();
+
+    if (record(alarm_expected, now)) {
+        counter_arm();
+    }
+}
+
+static void measure_counter(void)
+{
+    int ret;
+
+    if (!device_is_ready(counter_dev)) {
+        printk("Counter not ready, skipping\r\n");
+        return;
+    }
+
+    ret = counter_start(counter_dev);
+    if (ret < 0) {
+        printk("Error (%d): could not start counter\r\n", ret);
+        return;
+    }
+
+    measurement_start();
+    alarm_cfg.callback = counter_isr;
+    alarm_cfg.flags = 0;
+    counter_arm();
+
+    k_sem_take(&done_sem, K_FOREVER);
+    counter_stop(counter_dev);
+    bench_hist_print(&hist, "counter", "ns");
+}
+
+#endif /* HAS_COUNTER */
+
+//------------------------------------------------------------------------------
+// GPIO interrupt
+
+#if HAS_GPIO_IN
+
+static const struct gpio_dt_spec gpio_in = GPIO_DT_SPEC_GET(DT_ALIAS(my_gpio_in), gpios);
+#if HAS_GPIO_OUT
+static const struct gpio_dt_spec gpio_out = GPIO_DT_SPEC_GET(DT_ALIAS(my_gpio_out), gpios);
+#endif
+static struct gpio_callback gpio_cb_data;
+static volatile uint64_t edge_time;
+
+// GPIO callback (ISR)
+static void gpio_isr(const struct device *dev,
+                     struct gpio_callback *cb,
+                     uint32_t pins)
+{
+    uint64_t now = k_cycle_get_64();
+
+    if (samples_left > 0) {
+        record(edge_time, now);
+    }
+}
+
+// Drive the input pin: through a jumper from an output pin on hardware, or
+// through the emulator on native_sim (where the callback runs synchronously,
+// so only the GPIO callback dispatch path is measured)
+static void gpio_drive(int value)
+{
+#if HAS_GPIO_OUT
+    gpio_pin_set_dt(&gpio_out, value);
+#elif defined(CONFIG_GPIO_EMUL)
+    gpio_emul_input_set(gpio_in.port, gpio_in.pin, value);
+#endif
+}
+
+static void measure_gpio(void)
+{
+    int ret;
+
+    if (!gpio_is_ready_dt(&gpio_in)) {
+        printk("GPIO not ready, skipping\r\n");
+        return;
+    }
+
+#if HAS_GPIO_OUT
+    ret = gpio_pin_configure_dt(&gpio_out, GPIO_OUTPUT_INACTIVE);
+    if (ret < 0) {
+        printk("Error (%d): could not configure GPIO output\r\n", ret);
+        return;
+    }
+#elif !defined(CONFIG_GPIO_EMUL)
+    printk("No way to drive the GPIO input, skipping\r\n");
+    return;
+#endif
+
+    // Set the pin as an interrupt source
+    ret = gpio_pin_configure_dt(&gpio_in, GPIO_INPUT);
+    if (ret < 0) {
+        printk("Error (%d): could not configure GPIO input\r\n", ret);
+        return;
+    }
+    ret = gpio_pin_interrupt_configure_dt(&gpio_in, GPIO_INT_EDGE_TO_ACTIVE);
+    if (ret < 0) {
+        printk("Error (%d): could not configure GPIO interrupt\r\n", ret);
+        return;
+    }
+    gpio_init_callback(&gpio_cb_data, gpio_isr, BIT(gpio_in.pin));
+    gpio_add_callback(gpio_in.port, &gpio_cb_data);
+
+    measurement_start();
+
+    // Generate one rising edge per period (no more than one per sample, in
+    // case the edges never arrive)
+    for (int i = 0; (i < CONFIG_LATENCY_SAMPLES) && (samples_left > 0); i++) {
+        gpio_drive(0);
+        k_usleep(CONFIG_LATENCY_PERIOD_US);
+        edge_time = k_cycle_get_64();
+        gpio_drive(1);
+    }
+
+    // A missing jumper or wrong pin gives no interrupts: give the last edge
+    // a few periods, then carry on without this source
+    ret = k_sem_take(&done_sem, K_USEC(4 * CONFIG_LATENCY_PERIOD_US));
+    samples_left = 0;
+    gpio_pin_interrupt_configure_dt(&gpio_in, GPIO_INT_DISABLE);
+    gpio_remove_callback(gpio_in.port, &gpio_cb_data);
+    gpio_drive(0);
+
+    if (hist.count == 0) {
+        printk("No GPIO interrupts seen (check the out->in jumper), skipped\r\n");
+        return;
+    }
+    if (ret < 0) {
+        printk("Only %u of %u GPIO edges seen\r\n", hist.count, CONFIG_LATENCY_SAMPLES);
+    }
+    bench_hist_print(&hist, "gpio_isr", "ns");
+}
+
+#endif /* HAS_GPIO_IN */
+
+//------------------------------------------------------------------------------
+// Main
+
+int main(void)
+{
+    printk("Latency benchmark: %u samples every %u us\r\n",
+           CONFIG_LATENCY_SAMPLES,
+           CONFIG_LATENCY_PERIOD_US);
+    printk("Load: %u threads (prio %d), busy %u us (%u us irq locked), "
+           "sleep %u ms\r\n",
+           CONFIG_LATENCY_LOAD_THREADS,
+           CONFIG_LATENCY_LOAD_PRIORITY,
+           CONFIG_LATENCY_LOAD_BUSY_US,
+           CONFIG_LATENCY_LOAD_IRQ_LOCK_US,
+           CONFIG_LATENCY_LOAD_SLEEP_MS);
+
+    // Start the background load
+    for (int i = 0; i < CONFIG_LATENCY_LOAD_THREADS; i++) {
+        k_thread_create(&load_threads[i],
+                        load_stacks[i],
+                        K_THREAD_STACK_SIZEOF(load_stacks[i]),
+                        load_thread_start,
+                        NULL,
+                        NULL,
+                        NULL,
+                        CONFIG_LATENCY_LOAD_PRIORITY,
+                        0,
+                        K_NO_WAIT);
+    }
+
+    // Run each latency source in turn
+    measure_k_timer();
+#if HAS_COUNTER
+    measure_counter();
+#endif
+#if HAS_GPIO_IN
+    measure_gpio();
+#endif
+
+    printk("Done\r\n");
+
+    return 0;
+}
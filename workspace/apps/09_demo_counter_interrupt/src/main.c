@@ -2,10 +2,15 @@
 #include <zephyr/kernel.h>
 #include <zephyr/drivers/counter.h>
 
+#include "evlog.h"
+
 // Settings
 #define COUNTER_DELAY_US 1000000
 #define ALARM_CH_ID 0
 
+// Event logged from the ISR (printed later by the evlog thread)
+EVLOG_EVENT_DEFINE(counter_alarm, "Counter! ticks=%u");
+
 // Counter callback (ISR)
 void counter_isr(const struct device *dev,
                 uint8_t chan_id,
@@ -20,8 +25,8 @@ void counter_isr(const struct device *dev,
     alarm_cfg->ticks = counter_us_to_ticks(dev, COUNTER_DELAY_US);
     counter_set_channel_alarm(dev, ALARM_CH_ID, alarm_cfg);
 
-    // Do something
-    printk("Counter!\r\n");    
+    // Do something (printk here would stall the ISR on the UART)
+    EVLOG1(counter_alarm, ticks);
 }
 
 int main(void)
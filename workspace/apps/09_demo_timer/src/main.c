@@ -1,18 +1,27 @@
 #include <stdio.h>
 #include <zephyr/kernel.h>
 
+#include "evlog.h"
+
 // Settings
 #define TIMER_MS 1000
 
 // Struct for holding timer information
 static struct k_timer my_timer;
 
+// Number of times the timer has expired
+static uint32_t timer_count;
+
+// Event logged from the timer callback (printed later by the evlog thread)
+EVLOG_EVENT_DEFINE(timer_expired, "Timer! count=%u");
+
 // Timer callback
 void timer_callback(struct k_timer *timer)
 {
     // Check to make sure the correct timer triggered
     if (timer == &my_timer) {
-        printk("Timer!\r\n");
+        timer_count++;
+        EVLOG1(timer_expired, timer_count);
     }
 }
 
@@ -0,0 +1,83 @@
+#include <stdio.h>
+#include <zephyr/kernel.h>
+#include <zephyr/drivers/gpio.h>
+#include <zephyr/drivers/pwm.h>
+
+#include "pulse_capture.h"
+
+// Optional test signal (enabled by the my-pulse-gen Devicetree alias)
+#define HAS_PULSE_GEN DT_NODE_EXISTS(DT_ALIAS(my_pulse_gen))
+
+// Settings
+static const struct gpio_dt_spec pulse_in = GPIO_DT_SPEC_GET(DT_ALIAS(my_pulse_in), gpios);
+static const int32_t window_ms = 1000;
+#if HAS_PULSE_GEN
+static const struct pwm_dt_spec pulse_gen = PWM_DT_SPEC_GET(DT_ALIAS(my_pulse_gen));
+static const uint32_t gen_freq_hz = 10000;
+static const uint32_t gen_duty_permille = 250;
+#endif
+
+// Capture state (holds the edge ring, so keep it off the stack)
+static struct pulse_capture capture;
+
+int main(void)
+{
+    int ret;
+    struct pulse_stats stats;
+
+#if HAS_PULSE_GEN
+    // Start the test signal
+    if (!pwm_is_ready_dt(&pulse_gen)) {
+        printk("ERROR: PWM device %s is not ready\r\n", pulse_gen.dev->name);
+        return 0;
+    }
+    ret = pwm_set_dt(&pulse_gen,
+                     PWM_HZ(gen_freq_hz),
+                     PWM_HZ(gen_freq_hz) / 1000 * gen_duty_permille);
+    if (ret < 0) {
+        printk("Error (%d): could not start test signal\r\n", ret);
+        return 0;
+    }
+    printk("Test signal: %u Hz, %u.%u%% duty\r\n",
+           gen_freq_hz,
+           gen_duty_permille / 10,
+           gen_duty_permille % 10);
+#endif
+
+    // Start capturing edges
+    ret = pulse_capture_init(&capture, &pulse_in);
+    if (ret < 0) {
+        printk("Error (%d): could not start pulse capture\r\n", ret);
+        return 0;
+    }
+
+    // Throw away the partial first window
+    k_msleep(window_ms);
+    pulse_capture_measure(&capture, &stats);
+
+    // Report one measurement per window
+    while (1) {
+        k_msleep(window_ms);
+        pulse_capture_measure(&capture, &stats);
+
+        // Periods around lost edges are left out, the rest are still valid
+        if (stats.overruns > 0) {
+            printk("Lost %u edges, increase CONFIG_PULSE_CAPTURE_RING_SIZE\r\n",
+                   stats.overruns);
+        }
+
+        if (stats.periods == 0) {
+            printk("No signal (%u edges)\r\n", stats.edges);
+        } else {
+            printk("%u.%03u Hz, period %u ns, duty %u.%u%% (%u periods)\r\n",
+                   stats.freq_mhz / 1000,
+                   stats.freq_mhz % 1000,
+                   stats.period_ns,
+                   stats.duty_permille / 10,
+                   stats.duty_permille % 10,
+                   stats.periods);
+        }
+    }
+
+    return 0;
+}
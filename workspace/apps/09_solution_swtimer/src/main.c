@@ -0,0 +1,81 @@
+#include <stdio.h>
+#include <zephyr/kernel.h>
+#include <zephyr/drivers/counter.h>
+
+#include "swtimer.h"
+
+// Settings
+#define ALARM_CH_ID 0
+#define NUM_PERIODIC 24             // Periodic timers sharing one channel
+#define BASE_PERIOD_US 500          // Timer i runs every (i + 1) * 500 us
+#define ONE_SHOT_DELAY_US 2500000   // One-shot timer fires once after 2.5 s
+static const int32_t report_time_ms = 1000;
+
+// Timers and their expiry counts
+static struct swtimer periodic[NUM_PERIODIC];
+static struct swtimer one_shot;
+static volatile uint32_t counts[NUM_PERIODIC];
+
+// Periodic timer callback (ISR)
+static void periodic_handler(struct swtimer *timer, void *user_data)
+{
+    uint32_t idx = (uint32_t)(uintptr_t)user_data;
+
+    counts[idx]++;
+}
+
+// One-shot timer callback (ISR): restart the fastest timer at half speed to
+// show that callbacks may reprogram timers
+static void one_shot_handler(struct swtimer *timer, void *user_data)
+{
+    swtimer_start(&periodic[0], BASE_PERIOD_US * 2, BASE_PERIOD_US * 2);
+}
+
+int main(void)
+{
+    int ret;
+    struct swtimer_stats stats;
+    const struct device *counter_dev = DEVICE_DT_GET(DT_ALIAS(my_timer));
+
+    // Hand the alarm channel to the timer service
+    ret = swtimer_service_init(counter_dev, ALARM_CH_ID);
+    if (ret < 0) {
+        printk("Error (%d): could not start timer service\r\n", ret);
+        return 0;
+    }
+    printk("Timer service running at %u Hz\r\n",
+           counter_get_frequency(counter_dev));
+
+    // Start the periodic timers
+    for (int i = 0; i < NUM_PERIODIC; i++) {
+        swtimer_init(&periodic[i], periodic_handler, (void *)(uintptr_t)i);
+        ret = swtimer_start(&periodic[i],
+                            BASE_PERIOD_US * (i + 1),
+                            BASE_PERIOD_US * (i + 1));
+        if (ret < 0) {
+            printk("Error (%d): could not start timer %d\r\n", ret, i);
+            return 0;
+        }
+    }
+
+    // Start the one-shot timer
+    swtimer_init(&one_shot, one_shot_handler, NULL);
+    swtimer_start(&one_shot, ONE_SHOT_DELAY_US, 0);
+
+    // Print how often each timer fired in the last report period
+    while (1) {
+        k_msleep(report_time_ms);
+
+        swtimer_stats_get(&stats);
+        printk("Fired: %u, alarms: %u, max late: %u ticks\r\n",
+               stats.fired,
+               stats.alarms,
+               stats.max_late_ticks);
+        for (int i = 0; i < NUM_PERIODIC; i++) {
+            printk("  %5u us: %u\r\n", BASE_PERIOD_US * (i + 1), counts[i]);
+            counts[i] = 0;
+        }
+    }
+
+    return 0;
+}
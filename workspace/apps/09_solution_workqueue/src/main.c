@@ -2,38 +2,25 @@
 #include <zephyr/kernel.h>
 #include <zephyr/drivers/gpio.h>
 
-// Settings
-#define DEBOUNCE_DELAY_MS 50
+#include "debounce.h"
 
-// Button struct (from Devicetree)
-static const struct gpio_dt_spec btn = GPIO_DT_SPEC_GET(DT_ALIAS(my_button), gpios);
+// Every child of the node holding my-button is debounced (add more buttons
+// to the overlay and they are picked up automatically)
+#define BUTTONS_NODE DT_PARENT(DT_ALIAS(my_button))
+#define BUTTON_SPEC(node_id) GPIO_DT_SPEC_GET(node_id, gpios),
 
-// Struct for holding GPIO-related callback functions
-static struct gpio_callback btn_cb_data;
+// Button structs (from Devicetree)
+static const struct gpio_dt_spec buttons[] = {
+    DT_FOREACH_CHILD(BUTTONS_NODE, BUTTON_SPEC)
+};
 
-// Struct for holding the workqueue
-static struct k_work_delayable button_work;
-
-// GPIO callback (ISR)
-void button_isr(const struct device *dev, 
-                struct gpio_callback *cb, 
-                uint32_t pins)
-{
-    // Add work to the workqueue
-    k_work_reschedule(&button_work, K_MSEC(DEBOUNCE_DELAY_MS));
-}
-
-// Work handler: button pressed
-void button_work_handler(struct k_work *work)
+// Stable state change handler (runs on the debounce workqueue)
+static void button_handler(size_t idx, int state, void *user_data)
 {
-    int state;
-
-    // Read the state of the button (after the debounce delay)
-    state = gpio_pin_get_dt(&btn);
-    if (state < 0) {
-        printk("Error (%d): failed to read button pin\r\n", state);
-    } else if (state) {
-        printk("Doing some work...now with debounce!\r\n");
+    if (state) {
+        printk("Button %u pressed...now with debounce!\r\n", (unsigned int)idx);
+    } else {
+        printk("Button %u released\r\n", (unsigned int)idx);
     }
 }
 
@@ -41,32 +28,13 @@ int main(void)
 {
     int ret;
 
-    // Initialize work item
-    k_work_init_delayable(&button_work, button_work_handler);
-
-    // Make sure that the button was initialized
-    if (!gpio_is_ready_dt(&btn)) {
-        printk("ERROR: button not ready\r\n");
-        return 0;
-    }
-
-    // Set the button as input (apply extra flags if needed)
-    ret = gpio_pin_configure_dt(&btn, GPIO_INPUT);
+    // Configure the buttons and hand them to the debounce service
+    ret = debounce_init(buttons, ARRAY_SIZE(buttons), button_handler, NULL);
     if (ret < 0) {
-        printk("ERROR: could not set button to input\r\n");
+        printk("ERROR (%d): could not start debounce service\r\n", ret);
         return 0;
     }
-
-    // Configure the interrupt
-    ret = gpio_pin_interrupt_configure_dt(&btn, GPIO_INT_EDGE_TO_ACTIVE);
-    if (ret < 0) {
-        printk("ERROR: could not configure button as interrupt source\r\n");
-        return 0;
-    }
-
-    // Connect callback function (ISR) to interrupt source
-    gpio_init_callback(&btn_cb_data, button_isr, BIT(btn.pin));
-	gpio_add_callback(btn.port, &btn_cb_data);
+    printk("Debouncing %u button(s)\r\n", (unsigned int)ARRAY_SIZE(buttons));
 
     // Do nothing
     while (1) {
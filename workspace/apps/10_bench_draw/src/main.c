@@ -0,0 +1,289 @@
+#include <stdio.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <lvgl.h>
+
+#include "bench.h"
+#include "lvgl_port.h"
+#include "rgb565.h"
+
+// Benchmark settings
+#define BENCH_W 160                 // Same size as the ST7735R panel
+#define BENCH_H 80
+#define KERNEL_ITERATIONS 500       // Full-buffer passes per kernel
+#define DRAW_ITERATIONS 200         // LVGL draws per scene
+#define SPRITE_SIZE 64
+#define BLEND_OPA 128
+
+// Buffers (static so they do not sit on the main stack)
+static uint16_t dst[BENCH_W * BENCH_H];
+static uint16_t src[BENCH_W * BENCH_H];
+static uint8_t mask[BENCH_W * BENCH_H];
+LV_DRAW_BUF_DEFINE_STATIC(canvas_buf, BENCH_W, BENCH_H, LV_COLOR_FORMAT_RGB565);
+LV_DRAW_BUF_DEFINE_STATIC(sprite_buf, SPRITE_SIZE, SPRITE_SIZE, LV_COLOR_FORMAT_RGB565);
+
+//------------------------------------------------------------------------------
+// Common
+
+// Fill the sources with repeatable noise and a soft-edged mask
+static void make_input(void)
+{
+    uint32_t rnd = 0x12345678;
+
+    for (int i = 0; i < BENCH_W * BENCH_H; i++) {
+
+        // xorshift32 keeps the data identical between runs
+        rnd ^= rnd << 13;
+        rnd ^= rnd >> 17;
+        rnd ^= rnd << 5;
+
+        src[i] = (uint16_t)rnd;
+        dst[i] = (uint16_t)(rnd >> 16);
+        mask[i] = (uint8_t)((i % BENCH_W) * 255 / (BENCH_W - 1));
+    }
+}
+
+// Print pixels per second, one line per result so runs can be diffed
+static void report(const char *group, const char *name, uint64_t pixels, uint64_t cycles)
+{
+    uint64_t kpx_per_s = (cycles > 0) ? (pixels * bench_cycles_hz() / cycles / 1000) : 0;
+
+    printk("%-6s %-14s %8u kpx/s\r\n", group, name, (uint32_t)kpx_per_s);
+}
+
+//------------------------------------------------------------------------------
+// Kernels against per-pixel loops
+
+// Per-pixel fill, as a generic 16-bit loop writes it
+static void ref_fill(uint16_t *d, size_t n, uint16_t color)
+{
+    for (size_t i = 0; i < n; i++) {
+        d[i] = color;
+    }
+}
+
+// Per-pixel blends with LVGL's own mixing function
+static void ref_blend_mask(uint16_t *d, size_t n, uint16_t color, const uint8_t *m)
+{
+    for (size_t i = 0; i < n; i++) {
+        d[i] = lv_color_16_16_mix(color, d[i], m[i]);
+    }
+}
+
+static void ref_blend_image(uint16_t *d, const uint16_t *s, size_t n, uint8_t opa)
+{
+    for (size_t i = 0; i < n; i++) {
+        d[i] = lv_color_16_16_mix(s[i], d[i], opa);
+    }
+}
+
+static void bench_kernels(void)
+{
+    const size_t n = BENCH_W * BENCH_H;
+    const uint64_t pixels = (uint64_t)n * KERNEL_ITERATIONS;
+    const int32_t stride = BENCH_W * sizeof(uint16_t);
+    uint64_t start;
+
+    start = bench_cycles_get();
+    for (int i = 0; i < KERNEL_ITERATIONS; i++) {
+        ref_fill(dst, n, (uint16_t)i);
+    }
+    report("kernel", "fill_ref", pixels, bench_cycles_get() - start);
+
+    start = bench_cycles_get();
+    for (int i = 0; i < KERNEL_ITERATIONS; i++) {
+        rgb565_fill(dst, stride, BENCH_W, BENCH_H, (uint16_t)i);
+    }
+    report("kernel", "fill", pixels, bench_cycles_get() - start);
+
+    start = bench_cycles_get();
+    for (int i = 0; i < KERNEL_ITERATIONS; i++) {
+        ref_blend_mask(dst, n, (uint16_t)i, mask);
+    }
+    report("kernel", "mask_ref", pixels, bench_cycles_get() - start);
+
+    start = bench_cycles_get();
+    for (int i = 0; i < KERNEL_ITERATIONS; i++) {
+        rgb565_blend_color_mask(dst, stride, BENCH_W, BENCH_H,
+                                (uint16_t)i, mask, BENCH_W, LV_OPA_COVER);
+    }
+    report("kernel", "mask", pixels, bench_cycles_get() - start);
+
+    start = bench_cycles_get();
+    for (int i = 0; i < KERNEL_ITERATIONS; i++) {
+        ref_blend_image(dst, src, n, BLEND_OPA);
+    }
+    report("kernel", "image_opa_ref", pixels, bench_cycles_get() - start);
+
+    start = bench_cycles_get();
+    for (int i = 0; i < KERNEL_ITERATIONS; i++) {
+        rgb565_blend_image(dst, stride, src, stride, BENCH_W, BENCH_H,
+                           NULL, 0, BLEND_OPA);
+    }
+    report("kernel", "image_opa", pixels, bench_cycles_get() - start);
+
+    start = bench_cycles_get();
+    for (int i = 0; i < KERNEL_ITERATIONS; i++) {
+        rgb565_swap(dst, n);
+    }
+    report("kernel", "swap", pixels, bench_cycles_get() - start);
+
+    start = bench_cycles_get();
+    for (int i = 0; i < KERNEL_ITERATIONS; i++) {
+        lv_draw_sw_rgb565_swap(dst, n);
+    }
+    report("kernel", "swap_lvgl", pixels, bench_cycles_get() - start);
+}
+
+//------------------------------------------------------------------------------
+// LVGL scenes on a canvas (through the hooks when built with
+// lvgl_hooks.conf)
+
+// Full-canvas rectangle at the given opacity
+static uint32_t scene_rect(lv_layer_t *layer, lv_opa_t opa)
+{
+    lv_draw_rect_dsc_t dsc;
+    lv_area_t area = { 0, 0, BENCH_W - 1, BENCH_H - 1 };
+
+    lv_draw_rect_dsc_init(&dsc);
+    dsc.bg_color = lv_color_hex(0x3060C0);
+    dsc.bg_opa = opa;
+    lv_draw_rect(layer, &dsc, &area);
+
+    return BENCH_W * BENCH_H;
+}
+
+static uint32_t scene_fill(lv_layer_t *layer)
+{
+    return scene_rect(layer, LV_OPA_COVER);
+}
+
+static uint32_t scene_fill_opa(lv_layer_t *layer)
+{
+    return scene_rect(layer, BLEND_OPA);
+}
+
+// Anti-aliased circle (mask path)
+static uint32_t scene_circle(lv_layer_t *layer)
+{
+    lv_draw_rect_dsc_t dsc;
+    lv_area_t area = { 0, 0, BENCH_H - 1, BENCH_H - 1 };
+
+    lv_draw_rect_dsc_init(&dsc);
+    dsc.radius = LV_RADIUS_CIRCLE;
+    dsc.bg_color = lv_color_hex(0xFF0000);
+    dsc.bg_opa = LV_OPA_COVER;
+    lv_draw_rect(layer, &dsc, &area);
+
+    return BENCH_H * BENCH_H;
+}
+
+// RGB565 image, opaque and half transparent
+static uint32_t scene_image_opa(lv_layer_t *layer, lv_opa_t opa)
+{
+    lv_draw_image_dsc_t dsc;
+    lv_area_t area = { 0, 0, SPRITE_SIZE - 1, SPRITE_SIZE - 1 };
+
+    lv_draw_image_dsc_init(&dsc);
+    dsc.src = &sprite_buf;
+    dsc.opa = opa;
+    lv_draw_image(layer, &dsc, &area);
+
+    return SPRITE_SIZE * SPRITE_SIZE;
+}
+
+static uint32_t scene_image(lv_layer_t *layer)
+{
+    return scene_image_opa(layer, LV_OPA_COVER);
+}
+
+static uint32_t scene_image_half(lv_layer_t *layer)
+{
+    return scene_image_opa(layer, BLEND_OPA);
+}
+
+// Glyphs (8-bit coverage masks, counted by their bounding box)
+static uint32_t scene_text(lv_layer_t *layer)
+{
+    static const char text[] = "0123456789";
+    lv_draw_label_dsc_t dsc;
+    lv_area_t area = { 0, 0, BENCH_W - 1, BENCH_H - 1 };
+    lv_point_t size;
+
+    lv_draw_label_dsc_init(&dsc);
+    dsc.font = &lv_font_montserrat_20;
+    dsc.color = lv_color_black();
+    dsc.text = text;
+    lv_draw_label(layer, &dsc, &area);
+
+    lv_text_get_size(&size, text, dsc.font, 0, 0, LV_COORD_MAX, LV_TEXT_FLAG_NONE);
+
+    return size.x * size.y;
+}
+
+// Scenes to run
+static const struct {
+    const char *name;
+    uint32_t (*draw)(lv_layer_t *layer);
+} scenes[] = {
+    { "fill", scene_fill },
+    { "fill_opa", scene_fill_opa },
+    { "circle", scene_circle },
+    { "image", scene_image },
+    { "image_opa", scene_image_half },
+    { "text", scene_text },
+};
+
+static void bench_lvgl(void)
+{
+    lv_obj_t *canvas;
+    lv_layer_t layer;
+    uint64_t pixels;
+    uint64_t start;
+
+    LV_DRAW_BUF_INIT_STATIC(canvas_buf);
+    LV_DRAW_BUF_INIT_STATIC(sprite_buf);
+    memcpy(sprite_buf.data, src, SPRITE_SIZE * SPRITE_SIZE * sizeof(uint16_t));
+
+    canvas = lv_canvas_create(lv_screen_active());
+    lv_canvas_set_draw_buf(canvas, &canvas_buf);
+    lv_canvas_fill_bg(canvas, lv_color_white(), LV_OPA_COVER);
+
+    for (size_t s = 0; s < ARRAY_SIZE(scenes); s++) {
+        pixels = 0;
+        start = bench_cycles_get();
+        for (int i = 0; i < DRAW_ITERATIONS; i++) {
+            lv_canvas_init_layer(canvas, &layer);
+            pixels += scenes[s].draw(&layer);
+            lv_canvas_finish_layer(canvas, &layer);
+        }
+        report("lvgl", scenes[s].name, pixels, bench_cycles_get() - start);
+    }
+}
+
+//------------------------------------------------------------------------------
+// Main
+
+int main(void)
+{
+    printk("Draw benchmark: %ux%u RGB565, %s blend hooks\r\n",
+           BENCH_W,
+           BENCH_H,
+           IS_ENABLED(CONFIG_LV_DRAW_SW_ASM_CUSTOM) ? "rgb565" : "LVGL");
+    printk("Counter frequency: %u Hz\r\n", (uint32_t)bench_cycles_hz());
+
+    make_input();
+    bench_kernels();
+
+    if (lvgl_port_init() < 0) {
+        printk("Error: could not initialize LVGL\r\n");
+        return 0;
+    }
+    bench_lvgl();
+
+    // Touch the output so the work cannot be optimized away
+    printk("Last pixel: 0x%04x\r\n", dst[BENCH_W * BENCH_H - 1]);
+    printk("Done\r\n");
+
+    return 0;
+}
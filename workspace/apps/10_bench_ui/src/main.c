@@ -0,0 +1,215 @@
+#include <stdio.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <lvgl.h>
+
+#include "anim_scene.h"
+#include "bench.h"
+#include "board_scene.h"
+#include "lvgl_port.h"
+#include "sprite_cache.h"
+
+// Benchmark settings
+#define FRAME_MS 50                 // Simulated frame period (20 FPS)
+#define FRAMES_PER_S (1000 / FRAME_MS)
+#define SCENE_FRAMES 200            // Frames per scene (10 s of animation)
+
+// One screen from a display app: built once, then updated every frame
+struct scene {
+    const char *name;
+    void (*setup)(lv_obj_t *scr);
+    void (*update)(uint32_t frame);
+};
+
+// Results for one scene
+struct scene_result {
+    uint32_t frames;
+    uint64_t cpu_us;
+    uint32_t max_cpu_us;
+    uint64_t flush_us;
+    uint32_t max_flush_us;
+    uint64_t pixels;
+    uint32_t max_pixels;
+    uint64_t areas;
+    uint32_t max_mem;
+};
+
+// Panel width, for the circle sweep
+static uint32_t width;
+
+// Circle x offset for a frame: one sweep across the screen per second
+static int32_t circle_x(uint32_t frame, int32_t radius)
+{
+    return (int32_t)((frame % FRAMES_PER_S) * width / FRAMES_PER_S) - radius;
+}
+
+//------------------------------------------------------------------------------
+// Scenes, built by the apps' own scene code
+
+// 10_solution_animation: sprite circle and cached digit glyphs (the app
+// posts the same updates through the UI service)
+static void anim_update(uint32_t frame)
+{
+    char buf[12];
+
+    if ((frame % FRAMES_PER_S) == 0U) {
+        snprintk(buf, sizeof(buf), "%u", frame / FRAMES_PER_S);
+        anim_scene_set_counter(buf);
+    }
+    lv_obj_set_pos(anim_scene_circle(), circle_x(frame, ANIM_SCENE_CIRCLE_RADIUS), 0);
+}
+
+// 12_solution_custom_board: styled label and circle object
+static void board_update(uint32_t frame)
+{
+    if ((frame % FRAMES_PER_S) == 0U) {
+        board_scene_set_counter(frame / FRAMES_PER_S);
+    }
+    board_scene_set_circle_x(circle_x(frame, BOARD_SCENE_CIRCLE_RADIUS));
+}
+
+//------------------------------------------------------------------------------
+// Runner
+
+static const struct scene scenes[] = {
+    { "animation", anim_scene_create, anim_update },
+    { "custom_board", board_scene_create, board_update },
+};
+
+// Bytes of LVGL memory in use now, and the high-water mark so far
+static void mem_get(uint32_t *used, uint32_t *max_used, uint32_t *total)
+{
+    lv_mem_monitor_t mon;
+
+    lv_mem_monitor(&mon);
+    *used = mon.total_size - mon.free_size;
+    *max_used = mon.max_used;
+    *total = mon.total_size;
+}
+
+// Build a scene on a fresh screen and run its frames, one CSV line each
+static void scene_run(const struct scene *scene, struct scene_result *res)
+{
+    static lv_obj_t *prev_scr;
+    struct lvgl_port_stats stats;
+    lv_obj_t *scr;
+    uint64_t start;
+    uint32_t prev_frames;
+    uint32_t cpu_us;
+    uint32_t flush_us;
+    uint32_t areas;
+    uint32_t pixels;
+    uint32_t used;
+    uint32_t max_used;
+    uint32_t total;
+
+    scr = lv_obj_create(NULL);
+    lv_screen_load(scr);
+    if (prev_scr != NULL) {
+        lv_obj_delete(prev_scr);
+    }
+    prev_scr = scr;
+
+    scene->setup(scr);
+    memset(res, 0, sizeof(*res));
+
+    // Frame 0 draws the whole screen, later frames only what changed
+    for (uint32_t frame = 0; frame < SCENE_FRAMES; frame++) {
+        lvgl_port_stats_get(&stats);
+        prev_frames = stats.frames;
+        scene->update(frame);
+
+        start = bench_cycles_get();
+        lvgl_port_step();
+        cpu_us = (uint32_t)(bench_cycles_to_ns(bench_cycles_get() - start) / 1000);
+
+        // The last-frame figures only change when something was flushed
+        lvgl_port_stats_get(&stats);
+        if (stats.frames != prev_frames) {
+            flush_us = stats.last_flush_us;
+            areas = stats.last_frame_areas;
+            pixels = stats.last_frame_pixels;
+        } else {
+            flush_us = 0;
+            areas = 0;
+            pixels = 0;
+        }
+        mem_get(&used, &max_used, &total);
+
+        printk("frame,%s,%u,%u,%u,%u,%u,%u\r\n",
+               scene->name,
+               frame,
+               cpu_us,
+               flush_us,
+               areas,
+               pixels,
+               used);
+
+        res->frames++;
+        res->cpu_us += cpu_us;
+        res->max_cpu_us = MAX(res->max_cpu_us, cpu_us);
+        res->flush_us += flush_us;
+        res->max_flush_us = MAX(res->max_flush_us, flush_us);
+        res->pixels += pixels;
+        res->max_pixels = MAX(res->max_pixels, pixels);
+        res->areas += areas;
+        res->max_mem = MAX(res->max_mem, used);
+    }
+}
+
+int main(void)
+{
+    struct scene_result res[ARRAY_SIZE(scenes)];
+    struct lvgl_port_stats stats;
+    uint32_t used;
+    uint32_t max_used;
+    uint32_t total;
+
+    if (lvgl_port_init() < 0) {
+        printk("Error: could not initialize LVGL\r\n");
+        return 0;
+    }
+
+    lvgl_port_stats_get(&stats);
+    width = (uint32_t)lv_display_get_horizontal_resolution(NULL);
+    printk("UI benchmark: %u frames per scene, panel %u px, %u ms per frame\r\n",
+           SCENE_FRAMES,
+           stats.panel_pixels,
+           FRAME_MS);
+
+    // Sprites for the animation scene, as in the app
+    sprite_cache_init(lv_obj_get_style_bg_color(lv_screen_active(), LV_PART_MAIN));
+
+    // Per-frame results: CPU time for render and flush calls (host clock),
+    // panel time, flushed areas and pixels, LVGL memory in use
+    printk("frame,scene,n,cpu_us,flush_us,areas,pixels,mem_used\r\n");
+    for (size_t i = 0; i < ARRAY_SIZE(scenes); i++) {
+        scene_run(&scenes[i], &res[i]);
+    }
+
+    // Summary, one line per scene, then the LVGL memory high-water mark
+    printk("scene,name,frames,cpu_us_avg,cpu_us_max,flush_us_avg,flush_us_max,"
+           "pixels_avg,pixels_max,areas_avg,mem_max\r\n");
+    for (size_t i = 0; i < ARRAY_SIZE(scenes); i++) {
+        uint32_t n = MAX(res[i].frames, 1);
+
+        printk("scene,%s,%u,%u,%u,%u,%u,%u,%u,%u,%u\r\n",
+               scenes[i].name,
+               res[i].frames,
+               (uint32_t)(res[i].cpu_us / n),
+               res[i].max_cpu_us,
+               (uint32_t)(res[i].flush_us / n),
+               res[i].max_flush_us,
+               (uint32_t)(res[i].pixels / n),
+               res[i].max_pixels,
+               (uint32_t)(res[i].areas / n),
+               res[i].max_mem);
+    }
+    mem_get(&used, &max_used, &total);
+    printk("memory,max_used,total\r\n");
+    printk("memory,%u,%u\r\n", max_used, total);
+
+    printk("Done\r\n");
+
+    return 0;
+}
@@ -0,0 +1,139 @@
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <lvgl.h>
+
+#include "anim_scene.h"
+#include "sprite_cache.h"
+
+// Settings
+#define COUNTER_DIGITS 6
+#define CIRCLE_SPRITE_KEY 1
+
+// Styles and points must outlive the screen setup (LVGL keeps pointers)
+static lv_style_t rect_style;
+static lv_point_t rect_points[5] = { {0, 0}, {120, 0}, {120, 20}, {0, 20}, {0, 0} };
+
+// Counter digits, each showing a cached glyph sprite
+static lv_obj_t *counter;
+static lv_obj_t *counter_digits[COUNTER_DIGITS];
+static lv_obj_t *circle;
+static lv_color_t text_color;
+
+// Draw the circle once into its sprite
+static void circle_draw(lv_layer_t *layer, const lv_area_t *area, void *user_data)
+{
+	lv_draw_rect_dsc_t dsc;
+
+	lv_draw_rect_dsc_init(&dsc);
+	dsc.radius = LV_RADIUS_CIRCLE;
+	dsc.bg_color = lv_color_hex(0xFF0000);
+	dsc.bg_opa = LV_OPA_COVER;
+	lv_draw_rect(layer, &dsc, area);
+}
+
+// Unpin the sprite an image was showing when the image goes away
+static void sprite_image_delete_cb(lv_event_t *e)
+{
+	sprite_cache_release(lv_image_get_src(lv_event_get_target(e)));
+}
+
+// Show a sprite on an image, unpinning the one it showed before
+static void sprite_image_set(lv_obj_t *img, const lv_draw_buf_t *sprite)
+{
+	const void *prev = lv_image_get_src(img);
+
+	if (prev == sprite) {
+		sprite_cache_release(sprite);
+		return;
+	}
+	lv_image_set_src(img, sprite);
+	sprite_cache_release(prev);
+}
+
+// Build the screen
+void anim_scene_create(lv_obj_t *scr)
+{
+	lv_obj_t *hello_label;
+	lv_obj_t *rect;
+
+	// Sprites are drawn over the screen background in the theme's text colour
+	text_color = lv_obj_get_style_text_color(scr, LV_PART_MAIN);
+
+	// Create static label widget
+	hello_label = lv_label_create(scr);
+	lv_label_set_text(hello_label, "Hello, World!");
+	lv_obj_align(hello_label, LV_ALIGN_TOP_MID, 0, 5);
+
+	// Create the counter as a bare container of digit images
+	counter = lv_obj_create(scr);
+	lv_obj_remove_style_all(counter);
+	lv_obj_set_size(counter, 0, lv_font_get_line_height(&lv_font_montserrat_20));
+	lv_obj_align(counter, LV_ALIGN_BOTTOM_MID, 0, 0);
+	for (int i = 0; i < COUNTER_DIGITS; i++) {
+		counter_digits[i] = lv_image_create(counter);
+		lv_obj_add_flag(counter_digits[i], LV_OBJ_FLAG_HIDDEN);
+		lv_obj_add_event_cb(counter_digits[i], sprite_image_delete_cb,
+							LV_EVENT_DELETE, NULL);
+	}
+
+	// Set line style
+	lv_style_init(&rect_style);
+	lv_style_set_line_color(&rect_style, lv_color_hex(0x0000FF));
+	lv_style_set_line_width(&rect_style, 3);
+
+	// Create a rectangle out of lines
+	rect = lv_line_create(scr);
+	lv_obj_add_style(rect, &rect_style, 0);
+	lv_line_set_points(rect, rect_points, ARRAY_SIZE(rect_points));
+	lv_obj_align(rect, LV_ALIGN_TOP_MID, 0, 0);
+
+	// Create the circle as an image of its pre-rendered sprite
+	circle = lv_image_create(scr);
+	lv_obj_add_event_cb(circle, sprite_image_delete_cb, LV_EVENT_DELETE, NULL);
+	sprite_image_set(circle, sprite_cache_get(CIRCLE_SPRITE_KEY,
+											  ANIM_SCENE_CIRCLE_RADIUS * 2,
+											  ANIM_SCENE_CIRCLE_RADIUS * 2,
+											  circle_draw,
+											  NULL));
+	lv_obj_align(circle, LV_ALIGN_LEFT_MID, 0, 0);
+}
+
+// Show the text as a row of cached digit sprites instead of re-rendering
+// a label's glyphs. Each digit image keeps its sprite pinned.
+void anim_scene_set_counter(const char *text)
+{
+	const lv_draw_buf_t *sprite;
+	char digit[2] = { 0 };
+	int32_t x = 0;
+	size_t len = strnlen(text, COUNTER_DIGITS);
+
+	for (size_t i = 0; i < COUNTER_DIGITS; i++) {
+		sprite = NULL;
+		if (i < len) {
+			digit[0] = text[i];
+			sprite = sprite_cache_text(digit, &lv_font_montserrat_20, text_color);
+		}
+		if (sprite == NULL) {
+			lv_obj_add_flag(counter_digits[i], LV_OBJ_FLAG_HIDDEN);
+			sprite_image_set(counter_digits[i], NULL);
+			continue;
+		}
+		sprite_image_set(counter_digits[i], sprite);
+		lv_obj_set_pos(counter_digits[i], x, 0);
+		lv_obj_remove_flag(counter_digits[i], LV_OBJ_FLAG_HIDDEN);
+		x += sprite->header.w;
+	}
+
+	// Keep the row centered
+	lv_obj_set_width(counter, x);
+}
+
+lv_obj_t *anim_scene_counter(void)
+{
+	return counter;
+}
+
+lv_obj_t *anim_scene_circle(void)
+{
+	return circle;
+}
@@ -0,0 +1,21 @@
+#ifndef ANIM_SCENE_H_
+#define ANIM_SCENE_H_
+
+#include <stdint.h>
+#include <lvgl.h>
+
+#define ANIM_SCENE_CIRCLE_RADIUS 15
+
+// Build the screen: static label, line rectangle, counter made of cached
+// digit sprites and a sprite circle. Call sprite_cache_init() first.
+void anim_scene_create(lv_obj_t *scr);
+
+// Show text (digits) on the counter
+void anim_scene_set_counter(const char *text);
+
+// The counter container and the circle (e.g. to register with the UI
+// service or to move directly)
+lv_obj_t *anim_scene_counter(void);
+lv_obj_t *anim_scene_circle(void);
+
+#endif /* ANIM_SCENE_H_ */
@@ -1,27 +1,112 @@
 #include <zephyr/kernel.h>
 #include <zephyr/drivers/display.h>
 #include <lvgl.h>
-#include <string.h>
+
+#include "anim_scene.h"
+#include "lvgl_arena.h"
+#include "lvgl_port.h"
+#include "sprite_cache.h"
+#include "ui_service.h"
 
 // Settings
-static const int32_t sleep_time_ms = 50;	// Target 20 FPS
+static const int32_t frame_time_ms = 50;	// Target 20 FPS
+static const int32_t move_time_ms = 10;		// Producer posts faster than frames
+
+// Widget IDs for posting updates
+static int counter_id;
+static int circle_id;
+static uint32_t width;
+
+// Show a counter update on the scene's sprite digits (render thread, via
+// the UI service)
+static void counter_apply(lv_obj_t *obj, const struct ui_msg *msg)
+{
+	char buf[12];
+
+	if (msg->type == UI_MSG_INT) {
+		snprintk(buf, sizeof(buf), "%d", msg->value);
+		anim_scene_set_counter(buf);
+	} else {
+		anim_scene_set_counter(msg->text);
+	}
+}
+
+// Build the screen (runs in the render thread)
+static void screen_setup(void *user_data)
+{
+	// Get width of the default display
+	width = (uint32_t)lv_disp_get_hor_res(NULL);
+
+	// Sprites are drawn over the screen background
+	sprite_cache_init(lv_obj_get_style_bg_color(lv_scr_act(), LV_PART_MAIN));
+
+	anim_scene_create(lv_scr_act());
+	counter_id = ui_widget_add_cb(anim_scene_counter(), counter_apply);
+	circle_id = ui_widget_add(anim_scene_circle());
+}
+
+// Print the render loop, flush and UI service statistics for the last second
+static void print_stats(void)
+{
+	static struct ui_stats prev_ui_stats;
+	static struct lvgl_arena_stats prev_mem_stats;
+	static struct sprite_cache_stats prev_sprite_stats;
+	struct ui_stats ui_stats;
+	struct lvgl_arena_stats mem_stats;
+	struct sprite_cache_stats sprite_stats;
+
+	ui_stats_get(&ui_stats);
+	lvgl_arena_stats_get(&mem_stats);
+	sprite_cache_stats_get(&sprite_stats);
+
+	lvgl_port_stats_print();
+
+	printk("UI updates: %u posted, %u coalesced, %u applied, %u dropped\r\n",
+		   ui_stats.posted - prev_ui_stats.posted,
+		   ui_stats.coalesced - prev_ui_stats.coalesced,
+		   ui_stats.applied - prev_ui_stats.applied,
+		   ui_stats.dropped - prev_ui_stats.dropped);
+
+	printk("Sprites: %u hits, %u misses, %u evicted, %u cached, "
+		   "%u/%u B (peak %u), %u us rendering in total\r\n",
+		   sprite_stats.hits - prev_sprite_stats.hits,
+		   sprite_stats.misses - prev_sprite_stats.misses,
+		   sprite_stats.evictions - prev_sprite_stats.evictions,
+		   sprite_stats.entries,
+		   sprite_stats.bytes_used,
+		   sprite_stats.bytes_total,
+		   sprite_stats.bytes_peak,
+		   (uint32_t)sprite_stats.render_us);
+
+	// Steady-state frames should not allocate at all
+	printk("LVGL memory: %u allocs, %u frees, %u B in slabs (peak %u), "
+		   "%u B in heap (peak %u)\r\n",
+		   mem_stats.allocs - prev_mem_stats.allocs,
+		   mem_stats.frees - prev_mem_stats.frees,
+		   mem_stats.slab_used,
+		   mem_stats.slab_peak,
+		   mem_stats.heap_used,
+		   mem_stats.heap_peak);
+
+	prev_ui_stats = ui_stats;
+	prev_mem_stats = mem_stats;
+	prev_sprite_stats = sprite_stats;
+}
+
+// Called by the render thread after each frame's updates are applied
+static void frame_update(uint32_t frame, void *user_data)
+{
+	if ((frame % (1000 / frame_time_ms)) == 0U) {
+		print_stats();
+	}
+}
 
 int main(void)
 {
-	uint32_t count = 0;
-	char buf[11] = {0};
 	const struct device *display;
-	uint32_t width;
-	lv_obj_t *hello_label;
-	lv_obj_t *counter_label;
-	lv_obj_t *rect;
-	lv_obj_t *circle;
-	lv_style_t counter_label_style;
-	lv_style_t rect_style;
-	lv_style_t circle_style;
-	lv_point_t rect_points[5] = { {0, 0}, {120, 0}, {120, 20}, {0, 20}, {0, 0} };
-	const uint32_t circle_radius = 15;
-	uint32_t circle_pos = 0;
+	uint32_t count = 0;
+	int64_t start_ms;
+	int64_t elapsed_ms;
 
 	// Make sure the display has been initialized
 	display = DEVICE_DT_GET(DT_CHOSEN(zephyr_display));
@@ -30,74 +115,35 @@ int main(void)
 		return 0;
 	}
 
-	// Get width of the default display
-	width = (uint32_t)lv_disp_get_hor_res(NULL);
-
-	// Create static label widget
-	hello_label = lv_label_create(lv_scr_act());
-	lv_label_set_text(hello_label, "Hello, World!");
-	lv_obj_align(hello_label, LV_ALIGN_TOP_MID, 0, 5);
-
-	// Adjust style for counter label
-	lv_style_init(&counter_label_style);
-	lv_style_set_text_font(&counter_label_style, &lv_font_montserrat_20);
-
-	// Create dynamic label widget
-	counter_label = lv_label_create(lv_scr_act());
-	lv_obj_add_style(counter_label, &counter_label_style, 0);
-	lv_obj_align(counter_label, LV_ALIGN_BOTTOM_MID, 0, 0);
-
-	// Set line style
-	lv_style_init(&rect_style);
-    lv_style_set_line_color(&rect_style, lv_color_hex(0x0000FF));
-    lv_style_set_line_width(&rect_style, 3);
-
-	// Create a rectangle out of lines
-	rect = lv_line_create(lv_scr_act());
-	lv_obj_add_style(rect, &rect_style, 0);
-	lv_line_set_points(rect, 
-					   rect_points, 
-					   sizeof(rect_points) / sizeof(rect_points[0]));
-	lv_obj_align(rect, LV_ALIGN_TOP_MID, 0, 0);
-
-	// Set circle style
-	lv_style_init(&circle_style);
-	lv_style_set_radius(&circle_style, circle_radius);
-    lv_style_set_bg_opa(&circle_style, LV_OPA_100);
-    lv_style_set_bg_color(&circle_style, lv_color_hex(0xFF0000));
-
-	// Create an object with the new style
-	circle = lv_obj_create(lv_scr_act());
-	lv_obj_set_size(circle, circle_radius * 2, circle_radius * 2);
-	lv_obj_add_style(circle, &circle_style, 0);
-	lv_obj_align(circle, LV_ALIGN_LEFT_MID, 0, 0);
-
-	// lv_task_handler();
+	// Start the render thread (LVGL is only used from there from now on)
+	if (ui_start(frame_time_ms, screen_setup, frame_update, NULL) < 0) {
+		printk("Error: could not start UI\r\n");
+		return 0;
+	}
 	display_blanking_off(display);
 
-	// Do forever
+	// Show what building the screen took from each size class
+	lvgl_arena_stats_print();
+
+	// Act as a producer: post updates without ever touching LVGL
+	start_ms = k_uptime_get();
 	while (1) {
+		elapsed_ms = k_uptime_get() - start_ms;
 
 		// Update counter label every second
-		if ((count % (1000 / sleep_time_ms)) == 0U) {
-			sprintf(buf, "%d", count / (1000 / sleep_time_ms));
-			lv_label_set_text(counter_label, buf);
-		}
-		count++;
-
-		// Move the circle
-		if (circle_pos >= width) {
-			circle_pos = 0;
+		if ((elapsed_ms / 1000) >= count) {
+			ui_post_int(counter_id, count);
+			count++;
 		}
-		lv_obj_align(circle, 
-					 LV_ALIGN_LEFT_MID, 
-					 circle_pos - circle_radius, 0);
-		circle_pos += width / (1000 / sleep_time_ms);
 
-		// Must be called periodically
-		lv_task_handler();
+		// Move the circle across the screen once per second, from the time
+		// rather than a step per frame
+		ui_post_pos(circle_id,
+					(int16_t)((elapsed_ms % 1000) * width / 1000 - ANIM_SCENE_CIRCLE_RADIUS),
+					0);
 
-		// Sleep
-		k_msleep(sleep_time_ms);
+		k_msleep(move_time_ms);
 	}
+
+	return 0;
 }
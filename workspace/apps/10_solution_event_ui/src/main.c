@@ -0,0 +1,111 @@
+#include <zephyr/kernel.h>
+#include <zephyr/drivers/display.h>
+#include <zephyr/drivers/gpio.h>
+#ifdef CONFIG_GPIO_EMUL
+#include <zephyr/drivers/gpio/gpio_emul.h>
+#endif
+#include <lvgl.h>
+
+#include "lvgl_port.h"
+
+// Settings
+static const int32_t box_size = 30;
+static const int32_t box_step = 10;
+
+// Widgets changed by key events
+static lv_obj_t *count_label;
+static lv_obj_t *box;
+static uint32_t press_count;
+
+// Styles must outlive the screen setup (LVGL keeps pointers)
+static lv_style_t count_label_style;
+static lv_style_t box_style;
+
+// Box event handler: ENTER toggles the colour, RIGHT moves the box
+static void box_event_cb(lv_event_t *e)
+{
+	static bool red;
+
+	if (lv_event_get_code(e) == LV_EVENT_PRESSED) {
+		// Report the previous press (its latency is known once its refresh is out)
+		lvgl_port_stats_print();
+		red = !red;
+		lv_obj_set_style_bg_color(box,
+								  lv_color_hex(red ? 0xFF0000 : 0x0000FF),
+								  0);
+		press_count++;
+		lv_label_set_text_fmt(count_label, "Presses: %u", press_count);
+	} else if (lv_event_get_key(e) == LV_KEY_RIGHT) {
+		lv_obj_set_x(box, (lv_obj_get_x(box) + box_step) %
+						  (lv_display_get_horizontal_resolution(NULL) - box_size));
+	}
+}
+
+#if defined(CONFIG_GPIO_EMUL) && DT_NODE_EXISTS(DT_ALIAS(my_key_enter))
+
+// On native_sim nobody presses buttons: toggle the ENTER key every 2 seconds
+static const struct gpio_dt_spec key_enter = GPIO_DT_SPEC_GET(DT_ALIAS(my_key_enter), gpios);
+
+static void presser_thread_start(void *arg1, void *arg2, void *arg3)
+{
+	while (1) {
+		k_msleep(2000);
+		gpio_emul_input_set(key_enter.port, key_enter.pin, 1);
+		k_msleep(100);
+		gpio_emul_input_set(key_enter.port, key_enter.pin, 0);
+	}
+}
+
+K_THREAD_DEFINE(presser_thread, 1024, presser_thread_start, NULL, NULL, NULL,
+				10, 0, 1000);
+#endif
+
+int main(void)
+{
+	const struct device *display;
+	lv_group_t *group;
+
+	// Make sure the display has been initialized
+	display = DEVICE_DT_GET(DT_CHOSEN(zephyr_display));
+	if (!device_is_ready(display)) {
+		printk("Error: display not ready\r\n");
+		return 0;
+	}
+
+	// Set up LVGL with keypad input
+	if (lvgl_port_init() < 0) {
+		printk("Error: could not initialize LVGL\r\n");
+		return 0;
+	}
+
+	// Create the press counter label
+	lv_style_init(&count_label_style);
+	lv_style_set_text_font(&count_label_style, &lv_font_montserrat_20);
+	count_label = lv_label_create(lv_scr_act());
+	lv_obj_add_style(count_label, &count_label_style, 0);
+	lv_label_set_text(count_label, "Presses: 0");
+	lv_obj_align(count_label, LV_ALIGN_TOP_MID, 0, 5);
+
+	// Create the box that reacts to keys
+	lv_style_init(&box_style);
+	lv_style_set_bg_opa(&box_style, LV_OPA_100);
+	lv_style_set_bg_color(&box_style, lv_color_hex(0x0000FF));
+	box = lv_obj_create(lv_scr_act());
+	lv_obj_add_style(box, &box_style, 0);
+	lv_obj_set_size(box, box_size, box_size);
+	lv_obj_align(box, LV_ALIGN_BOTTOM_LEFT, 0, -5);
+	lv_obj_add_event_cb(box, box_event_cb, LV_EVENT_PRESSED, NULL);
+	lv_obj_add_event_cb(box, box_event_cb, LV_EVENT_KEY, NULL);
+
+	// Keys go to the focused object in the keypad's group
+	group = lv_group_create();
+	lv_group_add_obj(group, box);
+	lv_indev_set_group(lvgl_port_keypad_get(), group);
+
+	display_blanking_off(display);
+
+	// Sleep until a key, a timer or an invalidation needs the loop
+	lvgl_port_run_on_demand(NULL, NULL);
+
+	return 0;
+}
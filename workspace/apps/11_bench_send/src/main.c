@@ -0,0 +1,281 @@
+#include <stdio.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/net/socket.h>
+
+#include "bench.h"
+#include "net_iov.h"
+
+// Benchmark settings
+#define HEAD_MAX 192                // Room for the request line and headers
+#define PAYLOAD_MAX 4096
+#define SINK_THREAD_STACK_SIZE 2048
+#define SINK_THREAD_PRIORITY 6      // Below main (see run())
+
+BUILD_ASSERT(SINK_THREAD_PRIORITY > CONFIG_MAIN_THREAD_PRIORITY,
+             "The receiver must run at a lower priority than main");
+
+// Send paths under test
+enum send_path {
+    SEND_COPY,          // snprintf() headers, copy the payload, one send
+    SEND_PIECES,        // One send per piece, nothing copied
+    SEND_GATHER,        // One zsock_sendmsg() for all pieces
+};
+
+// The request: constant fragments around one formatted header and the
+// payload, the way an upload is usually put together
+static const char req_start[] = "POST /upload HTTP/1.1\r\nHost: ";
+static const char req_host[] = "collector.local";
+static const char req_type[] = "\r\nContent-Type: application/octet-stream\r\nContent-Length: ";
+
+// Payload sizes to compare (0 is a bare request)
+static const size_t payload_sizes[] = {0, 64, 512, 4096};
+
+static const char *const path_names[] = {
+    [SEND_COPY] = "copy",
+    [SEND_PIECES] = "pieces",
+    [SEND_GATHER] = "sendmsg",
+};
+
+// Define stack area for the receiving thread
+K_THREAD_STACK_DEFINE(sink_stack, SINK_THREAD_STACK_SIZE);
+
+// Globals (static so they do not sit on the main stack)
+static struct k_thread sink_thread;
+static K_SEM_DEFINE(sink_ready, 0, 1);
+static uint8_t payload[PAYLOAD_MAX];
+static char tx_buf[HEAD_MAX + PAYLOAD_MAX];
+static uint8_t rx_buf[1024];
+static size_t sink_bytes;
+static struct bench_hist hist;
+
+// Receiving thread entry point: accept one connection and discard
+// everything until it closes
+static void sink_thread_start(void *arg1, void *arg2, void *arg3)
+{
+    struct sockaddr_in addr;
+    int listen_sock;
+    int sock;
+    int one = 1;
+    int len;
+
+    listen_sock = zsock_socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (listen_sock < 0) {
+        printk("Error (%d): could not create socket\r\n", errno);
+        return;
+    }
+    zsock_setsockopt(listen_sock, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(CONFIG_SEND_BENCH_PORT);
+    zsock_inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+    if ((zsock_bind(listen_sock, (struct sockaddr *)&addr, sizeof(addr)) < 0) ||
+        (zsock_listen(listen_sock, 1) < 0)) {
+        printk("Error (%d): could not listen on port %u\r\n",
+               errno,
+               CONFIG_SEND_BENCH_PORT);
+        zsock_close(listen_sock);
+        return;
+    }
+    k_sem_give(&sink_ready);
+
+    sock = zsock_accept(listen_sock, NULL, NULL);
+    zsock_close(listen_sock);
+    if (sock < 0) {
+        printk("Error (%d): could not accept\r\n", errno);
+        return;
+    }
+
+    while ((len = zsock_recv(sock, rx_buf, sizeof(rx_buf), 0)) > 0) {
+        sink_bytes += len;
+    }
+    zsock_close(sock);
+}
+
+// Connect to the receiving thread
+static int connect_sink(void)
+{
+    struct sockaddr_in addr;
+    int sock;
+    int one = 1;
+
+    sock = zsock_socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (sock < 0) {
+        return -errno;
+    }
+
+    // Like a request/response client: each send goes out right away, so
+    // sending piece by piece costs one segment per piece
+    zsock_setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(CONFIG_SEND_BENCH_PORT);
+    zsock_inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+    if (zsock_connect(sock, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        int err = -errno;
+
+        zsock_close(sock);
+        return err;
+    }
+
+    return sock;
+}
+
+// Send all of buf, however many calls it takes
+static int send_all(int sock, const void *buf, size_t len)
+{
+    const uint8_t *p = buf;
+    int ret;
+
+    while (len > 0) {
+        ret = zsock_send(sock, p, len, 0);
+        if (ret < 0) {
+            return -errno;
+        }
+        p += ret;
+        len -= ret;
+    }
+
+    return 0;
+}
+
+// Build and send one request over the chosen path. Returns bytes sent or
+// a negative errno.
+static int send_request(int sock, enum send_path path, size_t payload_len)
+{
+    struct net_iov iov;
+    char length[16];
+    int len;
+    int ret;
+
+    switch (path) {
+    case SEND_COPY:
+        len = snprintf(tx_buf,
+                       HEAD_MAX,
+                       "%s%s%s%u\r\n\r\n",
+                       req_start,
+                       req_host,
+                       req_type,
+                       (unsigned int)payload_len);
+        memcpy(tx_buf + len, payload, payload_len);
+        len += payload_len;
+        ret = send_all(sock, tx_buf, len);
+        return (ret < 0) ? ret : len;
+
+    case SEND_PIECES:
+    case SEND_GATHER:
+        // Only the one header that changes is formatted
+        snprintf(length, sizeof(length), "%u\r\n\r\n", (unsigned int)payload_len);
+        net_iov_init(&iov);
+        net_iov_add(&iov, req_start, sizeof(req_start) - 1);
+        net_iov_add(&iov, req_host, sizeof(req_host) - 1);
+        net_iov_add(&iov, req_type, sizeof(req_type) - 1);
+        net_iov_add_str(&iov, length);
+        net_iov_add(&iov, payload, payload_len);
+        len = iov.len;
+
+        if (path == SEND_GATHER) {
+            return net_iov_send(sock, &iov, 0);
+        }
+        for (int i = 0; i < iov.count; i++) {
+            ret = send_all(sock, iov.vec[i].iov_base, iov.vec[i].iov_len);
+            if (ret < 0) {
+                return ret;
+            }
+        }
+        return len;
+    }
+
+    return -EINVAL;
+}
+
+// Time every request of one path and payload size, print the summary.
+// Returns the bytes sent. The receiver runs at a lower priority than main,
+// so it only drains the connection while a send blocks. A timed request is
+// the build plus the send calls into the stack, and once the send buffer
+// fills, the wait for the receiver to make room.
+static uint64_t run(int sock, enum send_path path, size_t payload_len)
+{
+    uint64_t bytes = 0;
+    uint64_t total = 0;
+    uint64_t start;
+    uint64_t ns;
+    int ret;
+
+    bench_hist_init(&hist, CONFIG_SEND_BENCH_BUCKET_NS);
+    for (int i = 0; i < CONFIG_SEND_BENCH_ITERATIONS; i++) {
+        start = bench_cycles_get();
+        ret = send_request(sock, path, payload_len);
+        ns = bench_cycles_to_ns(bench_cycles_get() - start);
+        if (ret < 0) {
+            printk("Error (%d): send failed\r\n", ret);
+            break;
+        }
+        bench_hist_add(&hist, (uint32_t)ns);
+        bytes += ret;
+        total += ns;
+    }
+
+    printk("%-8s %5u %8u %8u %8u %8u\r\n",
+           path_names[path],
+           (uint32_t)payload_len,
+           (uint32_t)(total / MAX(hist.count, 1)),
+           bench_hist_percentile(&hist, 500),
+           bench_hist_percentile(&hist, 990),
+           (uint32_t)(bytes * 1000 / MAX(total, 1)));
+
+    return bytes;
+}
+
+int main(void)
+{
+    uint64_t sent = 0;
+    int sock;
+
+    printk("Send path benchmark: %u requests per path and payload size\r\n",
+           CONFIG_SEND_BENCH_ITERATIONS);
+    printk("Counter frequency: %u Hz\r\n", (uint32_t)bench_cycles_hz());
+
+    // Payload contents do not matter, only that they are not all zero
+    for (int i = 0; i < PAYLOAD_MAX; i++) {
+        payload[i] = (uint8_t)i;
+    }
+
+    // Start the receiving end and connect to it over the loopback
+    k_thread_create(&sink_thread,
+                    sink_stack,
+                    K_THREAD_STACK_SIZEOF(sink_stack),
+                    sink_thread_start,
+                    NULL,
+                    NULL,
+                    NULL,
+                    SINK_THREAD_PRIORITY,
+                    0,
+                    K_NO_WAIT);
+    k_thread_name_set(&sink_thread, "send_sink");
+    k_sem_take(&sink_ready, K_FOREVER);
+    sock = connect_sink();
+    if (sock < 0) {
+        printk("Error (%d): could not connect\r\n", sock);
+        return 0;
+    }
+
+    // Per request: mean and percentiles of the time in the send path, and
+    // the resulting throughput
+    printk("%-8s %5s %8s %8s %8s %8s\r\n",
+           "path", "bytes", "mean ns", "p50 ns", "p99 ns", "MB/s");
+    for (size_t s = 0; s < ARRAY_SIZE(payload_sizes); s++) {
+        for (int p = SEND_COPY; p <= SEND_GATHER; p++) {
+            sent += run(sock, p, payload_sizes[s]);
+        }
+    }
+
+    // Check that every byte arrived
+    zsock_close(sock);
+    k_thread_join(&sink_thread, K_FOREVER);
+    printk("Sent %u bytes, received %u\r\n", (uint32_t)sent, (uint32_t)sink_bytes);
+
+    return 0;
+}
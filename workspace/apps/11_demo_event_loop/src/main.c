@@ -0,0 +1,174 @@
+#include <stdio.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/net/socket.h>
+
+// Custom libraries
+#include "net_loop.h"
+#ifdef CONFIG_WIFI_CONN
+#include "wifi_conn.h"
+#endif
+
+// WiFi settings
+#define WIFI_SSID "MySSID"
+#define WIFI_PSK "MyPassword"
+
+// One request and what came back
+struct endpoint {
+    struct net_txn txn;
+    char request[128];
+    uint16_t port;
+    uint32_t body_len;
+};
+
+// Globals
+static struct net_loop loop;
+static struct endpoint endpoints[CONFIG_LOOP_APP_REQUESTS];
+
+// Count the body as it arrives (nothing is stored)
+static void on_data(struct net_txn *txn, const uint8_t *data, size_t len)
+{
+    struct endpoint *ep = txn->user_data;
+
+    ep->body_len += len;
+}
+
+// Report each request as soon as it ends
+static void on_done(struct net_txn *txn, int result)
+{
+    struct endpoint *ep = txn->user_data;
+
+    if (result < 0) {
+        printk("  port %u: error %d after %u ms\r\n", ep->port, result, txn->elapsed_ms);
+    } else {
+        printk("  port %u: status %u, %u body bytes in %u ms\r\n",
+               ep->port,
+               txn->status,
+               ep->body_len,
+               txn->elapsed_ms);
+    }
+}
+
+// Resolve the server once (every request goes to the same host)
+static int resolve(struct sockaddr_storage *addr, socklen_t *addrlen)
+{
+    struct zsock_addrinfo hints;
+    struct zsock_addrinfo *res;
+    int ret;
+
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+
+    ret = zsock_getaddrinfo(CONFIG_LOOP_APP_HOST, NULL, &hints, &res);
+    if (ret != 0) {
+        printk("Error (%d): could not perform DNS lookup\r\n", ret);
+        return -EHOSTUNREACH;
+    }
+    memcpy(addr, res->ai_addr, res->ai_addrlen);
+    *addrlen = res->ai_addrlen;
+    zsock_freeaddrinfo(res);
+
+    return 0;
+}
+
+// Start one request on the loop
+static void start(struct endpoint *ep)
+{
+    int ret;
+
+    ep->body_len = 0;
+    ret = net_loop_add(&loop, &ep->txn);
+    if (ret < 0) {
+        printk("  port %u: could not start (%d)\r\n", ep->port, ret);
+    }
+}
+
+int main(void)
+{
+    struct sockaddr_storage addr;
+    socklen_t addrlen;
+    int64_t t_start;
+    uint32_t seq_ms;
+    uint32_t par_ms;
+    int ret;
+
+    printk("Event loop demo: %u requests to %s\r\n",
+           CONFIG_LOOP_APP_REQUESTS,
+           CONFIG_LOOP_APP_HOST);
+
+#ifdef CONFIG_WIFI_CONN
+    // Initialize WiFi
+    wifi_conn_init();
+
+    // Start connecting to the WiFi network (retries until it works)
+    ret = wifi_conn_connect(WIFI_SSID, WIFI_PSK);
+    if (ret < 0) {
+        printk("Error (%d): WiFi connection failed\r\n", ret);
+        return 0;
+    }
+
+    // Wait to receive an IP address
+    wifi_conn_wait_for_ip_addr(K_FOREVER);
+#endif
+
+    ret = resolve(&addr, &addrlen);
+    if (ret < 0) {
+        return 0;
+    }
+
+    // One HTTP GET per server, each on its own port
+    net_loop_init(&loop);
+    for (int i = 0; i < CONFIG_LOOP_APP_REQUESTS; i++) {
+        struct endpoint *ep = &endpoints[i];
+
+        ep->port = CONFIG_LOOP_APP_PORT_BASE + i;
+        snprintf(ep->request,
+                 sizeof(ep->request),
+                 "GET %s HTTP/1.1\r\nHost: %s:%u\r\nConnection: close\r\n\r\n",
+                 CONFIG_LOOP_APP_URL,
+                 CONFIG_LOOP_APP_HOST,
+                 ep->port);
+
+        ep->txn.addr = addr;
+        ep->txn.addrlen = addrlen;
+        net_sin((struct sockaddr *)&ep->txn.addr)->sin_port = htons(ep->port);
+        ep->txn.req = (const uint8_t *)ep->request;
+        ep->txn.req_len = strlen(ep->request);
+        ep->txn.timeout_ms = CONFIG_LOOP_APP_TIMEOUT_MS;
+        ep->txn.http = true;
+        ep->txn.on_data = on_data;
+        ep->txn.on_done = on_done;
+        ep->txn.user_data = ep;
+    }
+
+    // One at a time, as a blocking client would do it
+    printk("Sequential:\r\n");
+    t_start = k_uptime_get();
+    for (int i = 0; i < CONFIG_LOOP_APP_REQUESTS; i++) {
+        start(&endpoints[i]);
+        net_loop_run(&loop);
+    }
+    seq_ms = (uint32_t)(k_uptime_get() - t_start);
+
+    // All at once, still from this one thread
+    printk("Concurrent:\r\n");
+    t_start = k_uptime_get();
+    for (int i = 0; i < CONFIG_LOOP_APP_REQUESTS; i++) {
+        start(&endpoints[i]);
+    }
+    net_loop_run(&loop);
+    par_ms = (uint32_t)(k_uptime_get() - t_start);
+
+    printk("Sequential: %u ms, concurrent: %u ms\r\n", seq_ms, par_ms);
+    printk("Loop: %u started, %u completed, %u timed out, %u failed, "
+           "%u polls, %u in flight at most\r\n",
+           loop.stats.started,
+           loop.stats.completed,
+           loop.stats.timeouts,
+           loop.stats.errors,
+           loop.stats.polls,
+           loop.stats.max_active);
+
+    return 0;
+}
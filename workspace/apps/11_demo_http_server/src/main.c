@@ -0,0 +1,403 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/drivers/sensor.h>
+#include <zephyr/net/socket.h>
+
+// Custom libraries
+#include "http_serve.h"
+#ifdef CONFIG_SERVER_APP_BENCH
+#include "bench.h"
+#endif
+#ifdef CONFIG_WIFI_CONN
+#include "wifi_conn.h"
+#endif
+
+// WiFi settings
+#define WIFI_SSID "MySSID"
+#define WIFI_PSK "MyPassword"
+
+// Fields of the live resources (in template order)
+#define SENSOR_FIELD_TEMP 0
+#define SENSOR_FIELD_UPTIME 1
+#define STATS_FIELD_REQUESTS 0
+#define STATS_FIELD_ACCEPTED 1
+#define STATS_FIELD_ACTIVE 2
+#define STATS_FIELD_TX_BYTES 3
+
+// Use the MCP9808 if the board has one, else simulate a slow drift
+#define HAS_SENSOR DT_NODE_EXISTS(DT_ALIAS(my_mcp9808))
+
+#ifdef CONFIG_SERVER_APP_BENCH
+// Load generator settings
+#define BENCH_THREAD_STACK_SIZE 2048
+#define BENCH_THREAD_PRIORITY 11
+#define BENCH_HIST_BUCKET_US 50
+#endif
+
+// Page served from flash as is: polls /sensor and shows the reading
+static const char index_html[] =
+    "<!DOCTYPE html><html><head><title>Sensor</title></head><body>"
+    "<h1 id=\"t\">-</h1><p id=\"u\"></p><script>"
+    "async function f(){"
+    "const r=await fetch('/sensor');const j=await r.json();"
+    "document.getElementById('t').textContent=(j.temp_mC/1000).toFixed(2)+' C';"
+    "document.getElementById('u').textContent='uptime '+j.uptime_ms+' ms';}"
+    "setInterval(f," STRINGIFY(CONFIG_SERVER_APP_UPDATE_MS) ");f();"
+    "</script></body></html>";
+
+// Live resources: the whole response is pre-encoded and only the '#'
+// fields are rewritten. JSON allows the padding spaces.
+static const char sensor_template[] = "{\"temp_mC\":#######,\"uptime_ms\":##########}\n";
+static const char stats_template[] = "{\"requests\":##########,\"accepted\":##########,"
+                                     "\"active\":###,\"tx_bytes\":##########}\n";
+
+// Globals
+static struct http_serve_resource index_res;
+static struct http_serve_resource sensor_res;
+static struct http_serve_resource stats_res;
+static uint8_t sensor_buf[256];
+static uint8_t stats_buf[256];
+
+// Read the temperature in millidegrees
+static int read_temperature(int32_t *milli)
+{
+#if HAS_SENSOR
+    static const struct device *const mcp = DEVICE_DT_GET(DT_ALIAS(my_mcp9808));
+    struct sensor_value temperature;
+    int ret;
+
+    // Fetch the value from the sensor into the device's data struct
+    ret = sensor_sample_fetch(mcp);
+    if (ret < 0) {
+        printk("Sample fetch error: %d\r\n", ret);
+        return ret;
+    }
+
+    // Copy the value from the device's data struct into the local variable
+    ret = sensor_channel_get(mcp, SENSOR_CHAN_AMBIENT_TEMP, &temperature);
+    if (ret < 0) {
+        printk("Channel get error: %d\r\n", ret);
+        return ret;
+    }
+    *milli = (int32_t)sensor_value_to_milli(&temperature);
+#else
+    static int32_t step;
+
+    // 20-25 degrees in a triangle wave
+    step = (step + 1) % 200;
+    *milli = 20000 + ((step < 100) ? step : (200 - step)) * 50;
+#endif
+
+    return 0;
+}
+
+// Refresh the live resources in place (no allocation, no re-encoding)
+static void update_resources(void)
+{
+    struct http_serve_stats stats;
+    int32_t milli;
+
+    if (read_temperature(&milli) == 0) {
+        http_serve_set_int(&sensor_res, SENSOR_FIELD_TEMP, milli);
+    }
+    http_serve_set_int(&sensor_res, SENSOR_FIELD_UPTIME, (int32_t)k_uptime_get_32());
+
+    http_serve_stats_get(&stats);
+    http_serve_set_int(&stats_res, STATS_FIELD_REQUESTS, (int32_t)stats.requests);
+    http_serve_set_int(&stats_res, STATS_FIELD_ACCEPTED, (int32_t)stats.accepted);
+    http_serve_set_int(&stats_res, STATS_FIELD_ACTIVE, (int32_t)stats.active);
+    http_serve_set_int(&stats_res, STATS_FIELD_TX_BYTES, (int32_t)stats.tx_bytes);
+}
+
+// Register the resources
+static int add_resources(void)
+{
+    int ret;
+
+    ret = http_serve_add_static(&index_res,
+                                "/",
+                                "text/html",
+                                index_html,
+                                sizeof(index_html) - 1);
+    if (ret < 0) {
+        return ret;
+    }
+    ret = http_serve_add_dynamic(&sensor_res,
+                                 "/sensor",
+                                 "application/json",
+                                 sensor_buf,
+                                 sizeof(sensor_buf),
+                                 sensor_template);
+    if (ret < 0) {
+        return ret;
+    }
+
+    return http_serve_add_dynamic(&stats_res,
+                                  "/stats",
+                                  "application/json",
+                                  stats_buf,
+                                  sizeof(stats_buf),
+                                  stats_template);
+}
+
+#ifdef CONFIG_SERVER_APP_BENCH
+
+// One load generator client
+struct bench_client {
+    struct k_thread thread;
+    struct bench_hist hist;
+    bool keep_alive;
+    uint32_t errors;
+};
+
+// Globals
+K_THREAD_STACK_ARRAY_DEFINE(bench_stacks,
+                            CONFIG_SERVER_APP_BENCH_CLIENTS,
+                            BENCH_THREAD_STACK_SIZE);
+static struct bench_client clients[CONFIG_SERVER_APP_BENCH_CLIENTS];
+static struct bench_hist merged;
+
+// Open a connection to the server over the loopback
+static int bench_connect(void)
+{
+    struct sockaddr_in addr;
+    int sock;
+    int one = 1;
+
+    sock = zsock_socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (sock < 0) {
+        return -errno;
+    }
+    zsock_setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(CONFIG_HTTP_SERVE_PORT);
+    zsock_inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+    if (zsock_connect(sock, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        int err = -errno;
+
+        zsock_close(sock);
+        return err;
+    }
+
+    return sock;
+}
+
+// Send one request and read the whole response (headers + Content-Length)
+static int bench_request(int sock, const char *req, size_t req_len)
+{
+    char buf[512];
+    size_t len = 0;
+    size_t want = 0;
+    int ret;
+
+    if (zsock_send(sock, req, req_len, 0) != (ssize_t)req_len) {
+        return -EIO;
+    }
+
+    while ((want == 0) || (len < want)) {
+        ret = zsock_recv(sock, buf + len, sizeof(buf) - 1 - len, 0);
+        if (ret <= 0) {
+            return -EIO;
+        }
+        len += ret;
+        buf[len] = '\0';
+
+        // Work out the full length once the headers are in
+        if (want == 0) {
+            char *end = strstr(buf, "\r\n\r\n");
+            char *cl = strstr(buf, "Content-Length:");
+
+            if ((end != NULL) && (cl != NULL)) {
+                want = (end + 4 - buf) + strtoul(cl + 15, NULL, 10);
+            } else if (len >= sizeof(buf) - 1) {
+                return -EMSGSIZE;
+            }
+        }
+    }
+
+    return (strncmp(buf, "HTTP/1.1 200", 12) == 0) ? 0 : -EBADMSG;
+}
+
+// Client thread entry point: time each request, on one kept-alive
+// connection or on a new connection every time
+static void bench_thread_start(void *arg1, void *arg2, void *arg3)
+{
+    struct bench_client *client = arg1;
+    static const char req_keep[] = "GET /sensor HTTP/1.1\r\nHost: localhost\r\n\r\n";
+    static const char req_close[] = "GET /sensor HTTP/1.1\r\nHost: localhost\r\n"
+                                    "Connection: close\r\n\r\n";
+    const char *req = client->keep_alive ? req_keep : req_close;
+    size_t req_len = client->keep_alive ? sizeof(req_keep) - 1 : sizeof(req_close) - 1;
+    int sock = -1;
+
+    for (int i = 0; i < CONFIG_SERVER_APP_BENCH_REQUESTS; i++) {
+        uint64_t start = bench_cycles_get();
+
+        if (sock < 0) {
+            sock = bench_connect();
+            if (sock < 0) {
+                client->errors++;
+                continue;
+            }
+        }
+        if (bench_request(sock, req, req_len) < 0) {
+            client->errors++;
+            zsock_close(sock);
+            sock = -1;
+            continue;
+        }
+        if (!client->keep_alive) {
+            zsock_close(sock);
+            sock = -1;
+        }
+        bench_hist_add(&client->hist,
+                       (uint32_t)(bench_cycles_to_ns(bench_cycles_get() - start) / 1000));
+    }
+    if (sock >= 0) {
+        zsock_close(sock);
+    }
+}
+
+// Run all clients at once and print rate and latency
+static void bench_run(bool keep_alive)
+{
+    uint64_t start;
+    uint64_t elapsed_us;
+    uint32_t errors = 0;
+
+    for (int i = 0; i < CONFIG_SERVER_APP_BENCH_CLIENTS; i++) {
+        clients[i].keep_alive = keep_alive;
+        clients[i].errors = 0;
+        bench_hist_init(&clients[i].hist, BENCH_HIST_BUCKET_US);
+    }
+
+    start = bench_cycles_get();
+    for (int i = 0; i < CONFIG_SERVER_APP_BENCH_CLIENTS; i++) {
+        k_thread_create(&clients[i].thread,
+                        bench_stacks[i],
+                        K_THREAD_STACK_SIZEOF(bench_stacks[i]),
+                        bench_thread_start,
+                        &clients[i],
+                        NULL,
+                        NULL,
+                        BENCH_THREAD_PRIORITY,
+                        0,
+                        K_NO_WAIT);
+    }
+    for (int i = 0; i < CONFIG_SERVER_APP_BENCH_CLIENTS; i++) {
+        k_thread_join(&clients[i].thread, K_FOREVER);
+    }
+    elapsed_us = bench_cycles_to_ns(bench_cycles_get() - start) / 1000;
+
+    // Merge the per-client histograms (no locking while measuring)
+    bench_hist_init(&merged, BENCH_HIST_BUCKET_US);
+    for (int i = 0; i < CONFIG_SERVER_APP_BENCH_CLIENTS; i++) {
+        const struct bench_hist *h = &clients[i].hist;
+
+        for (int b = 0; b < CONFIG_BENCH_HIST_BUCKETS; b++) {
+            merged.buckets[b] += h->buckets[b];
+        }
+        merged.count += h->count;
+        merged.sum += h->sum;
+        merged.min = MIN(merged.min, h->min);
+        merged.max = MAX(merged.max, h->max);
+        errors += clients[i].errors;
+    }
+
+    printk("%s: %u requests from %u clients in %u ms, %u req/s, %u errors\r\n",
+           keep_alive ? "Keep-alive" : "New connection per request",
+           merged.count,
+           CONFIG_SERVER_APP_BENCH_CLIENTS,
+           (uint32_t)(elapsed_us / 1000),
+           (uint32_t)((uint64_t)merged.count * 1000000 / MAX(elapsed_us, 1)),
+           errors);
+    if (merged.count > 0) {
+        printk("  Latency p50 %u us, p99 %u us, max %u us\r\n",
+               bench_hist_percentile(&merged, 500),
+               bench_hist_percentile(&merged, 990),
+               merged.max);
+    }
+}
+
+#endif /* CONFIG_SERVER_APP_BENCH */
+
+int main(void)
+{
+    struct http_serve_stats stats;
+    int ret;
+
+    printk("HTTP server demo: live data refreshed every %u ms\r\n",
+           CONFIG_SERVER_APP_UPDATE_MS);
+
+#if HAS_SENSOR
+    // Check if the MCP9808 has been initialized (init function called)
+    if (!device_is_ready(DEVICE_DT_GET(DT_ALIAS(my_mcp9808)))) {
+        printk("Sensor is not ready\r\n");
+        return 0;
+    }
+#endif
+
+#ifdef CONFIG_WIFI_CONN
+    // Initialize WiFi
+    wifi_conn_init();
+
+    // Start connecting to the WiFi network (retries until it works)
+    ret = wifi_conn_connect(WIFI_SSID, WIFI_PSK);
+    if (ret < 0) {
+        printk("Error (%d): WiFi connection failed\r\n", ret);
+        return 0;
+    }
+
+    // Wait to receive an IP address
+    wifi_conn_wait_for_ip_addr(K_FOREVER);
+#endif
+
+    // Build the responses once, then serve them
+    ret = add_resources();
+    if (ret < 0) {
+        printk("Error (%d): could not add resources\r\n", ret);
+        return 0;
+    }
+    update_resources();
+    ret = http_serve_start();
+    if (ret < 0) {
+        printk("Error (%d): could not start server\r\n", ret);
+        return 0;
+    }
+    printk("Serving /, /sensor and /stats on port %u\r\n", CONFIG_HTTP_SERVE_PORT);
+
+#ifdef CONFIG_SERVER_APP_BENCH
+    // Same load twice: reusing connections vs a TCP handshake per request
+    bench_run(true);
+    bench_run(false);
+#endif
+
+    // Refresh the live data and report the server counters now and then
+    for (uint32_t n = 1;; n++) {
+        k_msleep(CONFIG_SERVER_APP_UPDATE_MS);
+        update_resources();
+
+        if ((n % 20) == 0) {
+            http_serve_stats_get(&stats);
+            printk("Server: %u requests on %u connections (%u active, %u at most), "
+                   "%u not found, %u bad, %u idle closed, %u send timeouts, %u polls, "
+                   "%u bytes sent\r\n",
+                   stats.requests,
+                   stats.accepted,
+                   stats.active,
+                   stats.max_active,
+                   stats.not_found,
+                   stats.bad_requests,
+                   stats.idle_closed,
+                   stats.send_timeouts,
+                   stats.polls,
+                   stats.tx_bytes);
+        }
+    }
+
+    return 0;
+}
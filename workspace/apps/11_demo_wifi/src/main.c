@@ -4,7 +4,8 @@
 #include <zephyr/net/socket.h>
 
 // Custom libraries
-#include "wifi.h"
+#include "net_iov.h"
+#include "wifi_conn.h"
 
 // WiFi settings
 #define WIFI_SSID "MySSID"
@@ -49,7 +50,7 @@ int main(void)
 {
     struct zsock_addrinfo hints;
     struct zsock_addrinfo *res;
-    char http_request[512];
+    struct net_iov request;
     int sock;
     int len;
     uint32_t rx_total;
@@ -58,24 +59,25 @@ int main(void)
     printk("HTTP GET Demo\r\n");
 
     // Initialize WiFi
-    wifi_init();
+    wifi_conn_init();
 
-    // Connect to the WiFi network (blocking)
-    ret = wifi_connect(WIFI_SSID, WIFI_PSK);
+    // Start connecting to the WiFi network (retries until it works)
+    ret = wifi_conn_connect(WIFI_SSID, WIFI_PSK);
     if (ret < 0) {
         printk("Error (%d): WiFi connection failed\r\n", ret);
         return 0;
     }
 
-    // Wait to receive an IP address (blocking)
-    wifi_wait_for_ip_addr();
+    // Wait to receive an IP address
+    wifi_conn_wait_for_ip_addr(K_FOREVER);
 
-    // Construct HTTP GET request
-    snprintf(http_request,
-             sizeof(http_request),
-             "GET %s HTTP/1.1\r\nHost: %s\r\n\r\n",
-             HTTP_URL,
-             HTTP_HOST);
+    // Construct HTTP GET request from its pieces (nothing is copied)
+    net_iov_init(&request);
+    net_iov_add_str(&request, "GET ");
+    net_iov_add_str(&request, HTTP_URL);
+    net_iov_add_str(&request, " HTTP/1.1\r\nHost: ");
+    net_iov_add_str(&request, HTTP_HOST);
+    net_iov_add_str(&request, "\r\n\r\n");
 
     // Clear and set address info
     memset(&hints, 0, sizeof(hints));
@@ -97,6 +99,7 @@ int main(void)
     sock = zsock_socket(res->ai_family, res->ai_socktype, res->ai_protocol);
     if (sock < 0) {
         printk("Error (%d): Could not create socket\r\n", errno);
+        zsock_freeaddrinfo(res);
         return 0;
     }
 
@@ -104,14 +107,18 @@ int main(void)
     ret = zsock_connect(sock, res->ai_addr, res->ai_addrlen);
     if (ret < 0) {
         printk("Error (%d): Could not connect the socket\r\n", errno);
+        zsock_freeaddrinfo(res);
         return 0;
     }
 
+    // The lookup results are no longer needed
+    zsock_freeaddrinfo(res);
+
     // Set the request
     printk("Sending HTTP request...\r\n");
-    ret = zsock_send(sock, http_request, strlen(http_request), 0);
+    ret = net_iov_send(sock, &request, 0);
     if (ret < 0) {
-        printk("Error (%d): Could not send request\r\n", errno);
+        printk("Error (%d): Could not send request\r\n", ret);
         return 0;
     }
 
@@ -3,17 +3,23 @@
 #include <zephyr/kernel.h>
 #include <zephyr/net/socket.h>
 #include <zephyr/net/http/client.h>
+#ifdef CONFIG_HTTP_APP_HTTPS
+#include <zephyr/net/tls_credentials.h>
+#endif
 
 // Custom libraries
-#include "wifi.h"
+#include "dns_cache.h"
+#include "http_pool.h"
+#include "http_stream.h"
+#ifdef CONFIG_WIFI_CONN
+#include "wifi_conn.h"
+#endif
 
 // WiFi settings
 #define WIFI_SSID "MySSID"
 #define WIFI_PSK "MyPassword"
 
-// HTTP GET settings
-#define HTTP_HOST "example.com"
-#define HTTP_URL "/"
+// HTTP GET settings (server, path and request count are set in Kconfig)
 #define HTTP_TIMEOUT_MS 3000
 
 // HTTP buffer settings
@@ -22,128 +28,163 @@
 // Globals
 static uint8_t recv_buf[HTTP_RECV_BUF_LEN];
 
-// HTTP request callback
-static void response_callback(struct http_response *resp,
-			                  enum http_final_call final_data,
-			                  void *user_data)
+#ifdef HTTP_APP_HAVE_CA_CERT
+// CA certificate for the server (from CONFIG_HTTP_APP_CA_CERT)
+static const unsigned char ca_cert[] = {
+#include "ca_cert.der.inc"
+};
+#endif
+
+// Response sinks: headers go to the console, the body only into a checksum,
+// so a download of any size runs in the receive buffer alone
+static struct http_stream stream;
+static struct http_sink_print print_sink;
+static struct http_sink_crc32 crc_sink;
+
+// Print the pool counters
+static void print_pool_stats(void)
 {
-    char temp_buf[HTTP_RECV_BUF_LEN + 1];
-
-    // Check if we still have more data to receive
-	if (final_data == HTTP_DATA_MORE) {
-		printk("Partial data received (%d bytes)\r\n", resp->data_len);
-	} else if (final_data == HTTP_DATA_FINAL) {
-		printk("All data received (%d bytes)\r\n", resp->data_len);
-	}
-
-    // Print the received data (up to data_len bytes)
-    memcpy(temp_buf, resp->recv_buf, resp->data_len);
-    temp_buf[resp->data_len] = '\0';
-    printk("Received data:\r\n%s\r\n", temp_buf);
+    struct http_pool_stats stats;
+
+    http_pool_stats_get(&stats);
+    printk("Pool: %u requests, %u reused, %u handshakes, %u DNS lookups, "
+           "%u closed by server, %u expired, %u retries, %u errors\r\n",
+           stats.requests,
+           stats.reused,
+           stats.handshakes,
+           stats.dns_lookups,
+           stats.server_closed,
+           stats.expired,
+           stats.retries,
+           stats.errors);
+#ifdef CONFIG_HTTP_APP_HTTPS
+    printk("TLS: %u handshakes, last %u ms, average %u ms, max %u ms, "
+           "heap %u bytes now, %u peak\r\n",
+           stats.tls_handshakes,
+           stats.tls_last_ms,
+           stats.tls_total_ms / MAX(stats.tls_handshakes, 1),
+           stats.tls_max_ms,
+           stats.tls_heap_used,
+           stats.tls_heap_peak);
+#endif
 }
 
-
-// Print the results of a DNS lookup
-void print_addrinfo(struct zsock_addrinfo **results)
+// Print the DNS cache counters
+static void print_dns_stats(void)
 {
-	char ipv4[INET_ADDRSTRLEN];
-	char ipv6[INET6_ADDRSTRLEN];
-	struct sockaddr_in *sa;
-	struct sockaddr_in6 *sa6;
-	struct zsock_addrinfo *rp;
-	
-    // Iterate through the results
-	for (rp = *results; rp != NULL; rp = rp->ai_next) {
-
-        // Print the IP address (IPv4)
-		if (rp->ai_addr->sa_family == AF_INET) {
-			sa = (struct sockaddr_in *) rp->ai_addr;
-			zsock_inet_ntop(AF_INET, &sa->sin_addr, ipv4, INET_ADDRSTRLEN);
-			printf("IPv4: %s\n", ipv4);
-		}
-
-        // Print the IP address (IPv6)
-		if (rp->ai_addr->sa_family == AF_INET6) {
-			sa6 = (struct sockaddr_in6 *) rp->ai_addr;
-			zsock_inet_ntop(AF_INET6, &sa6->sin6_addr, ipv6, INET6_ADDRSTRLEN);
-			printf("IPv6: %s\n", ipv6);
-		}
-	}
+    struct dns_cache_stats stats;
+
+    dns_cache_stats_get(&stats);
+    printk("DNS: %u lookups, %u hits, %u misses, %u coalesced, "
+           "%u prefetched, %u expired, %u failed, %u failovers\r\n",
+           stats.lookups,
+           stats.hits,
+           stats.misses,
+           stats.coalesced,
+           stats.prefetches,
+           stats.expired,
+           stats.failures,
+           stats.failovers);
 }
 
 int main(void)
 {
-    struct zsock_addrinfo hints;
-    struct zsock_addrinfo *res;
-    int sock;
     int ret;
     struct http_request req;
+    int64_t start;
+    uint32_t ms;
 
     printk("HTTP Client Subsystem Demo\r\n");
 
+#ifdef CONFIG_WIFI_CONN
     // Initialize WiFi
-    wifi_init();
+    wifi_conn_init();
 
-    // Connect to the WiFi network (blocking)
-    ret = wifi_connect(WIFI_SSID, WIFI_PSK);
+    // Start connecting to the WiFi network (retries until it works)
+    ret = wifi_conn_connect(WIFI_SSID, WIFI_PSK);
     if (ret < 0) {
         printk("Error (%d): WiFi connection failed\r\n", ret);
         return 0;
     }
 
-    // Wait to receive an IP address (blocking)
-    wifi_wait_for_ip_addr();
-
-    // Clear and set address info
-    memset(&hints, 0, sizeof(hints));
-    hints.ai_family = AF_INET;          // IPv4
-    hints.ai_socktype = SOCK_STREAM;    // TCP socket
-
-    // Perform DNS lookup
-    printk("Performing DNS lookup...\r\n");
-    ret = zsock_getaddrinfo(HTTP_HOST, "80", &hints, &res);
-    if (ret != 0) {
-        printk("Error (%d): could not perform DNS lookup\r\n", ret);
-        return 0;
-    }
-
-    // Print the results of the DNS lookup
-    print_addrinfo(&res);
+    // Wait to receive an IP address
+    wifi_conn_wait_for_ip_addr(K_FOREVER);
+#endif
 
-    // Create a new socket
-    sock = zsock_socket(res->ai_family, res->ai_socktype, res->ai_protocol);
-    if (sock < 0) {
-        printk("Error (%d): could not create socket\r\n", errno);
-        return 0;
-    }
-    printk("Socket created. File descriptor: %d\r\n", sock);
-
-    // Connect the socket
-    ret = zsock_connect(sock, res->ai_addr, res->ai_addrlen);
+#ifdef HTTP_APP_HAVE_CA_CERT
+    // Register the CA certificate the pool verifies servers with
+    ret = tls_credential_add(CONFIG_HTTP_POOL_TLS_SEC_TAG,
+                             TLS_CREDENTIAL_CA_CERTIFICATE,
+                             ca_cert,
+                             sizeof(ca_cert));
     if (ret < 0) {
-        printk("Error (%d): could not connect the socket\r\n", errno);
+        printk("Error (%d): could not register CA certificate\r\n", ret);
         return 0;
     }
+#elif defined(CONFIG_HTTP_APP_HTTPS) && defined(CONFIG_HTTP_POOL_TLS_VERIFY)
+    printk("Warning: no CA certificate (CONFIG_HTTP_APP_CA_CERT), "
+           "server verification will fail\r\n");
+#endif
+
+    // Start resolving the server while the request is set up
+    dns_cache_prefetch(CONFIG_HTTP_APP_HOST);
 
     // Configure request
     memset(&req, 0, sizeof(req));
     req.method = HTTP_GET;
-    req.url = HTTP_URL;
-    req.host = HTTP_HOST;
+    req.url = CONFIG_HTTP_APP_URL;
+    req.host = CONFIG_HTTP_APP_HOST;
     req.protocol = "HTTP/1.1";
-    req.response = response_callback;
     req.recv_buf = recv_buf;
     req.recv_buf_len = sizeof(recv_buf);
 
-    // Make request
-    ret = http_client_req(sock, &req, HTTP_TIMEOUT_MS, NULL);
-    if (ret < 0) {
-        printk("Error (%d): HTTP request failed\r\n", ret);
-        return 0;
+    // Set up the response sinks
+    http_stream_init(&stream);
+    http_sink_print_init(&print_sink, false);
+    http_sink_crc32_init(&crc_sink);
+    http_stream_add(&stream, &print_sink.sink);
+    http_stream_add(&stream, &crc_sink.sink);
+
+    // Make requests, the pool keeps the connection (and address) between them
+    for (int i = 0; i < CONFIG_HTTP_APP_REQUESTS; i++) {
+        http_sink_crc32_init(&crc_sink);
+        http_stream_attach(&stream, &req);
+
+        start = k_uptime_get();
+#ifdef CONFIG_HTTP_APP_HTTPS
+        ret = http_pool_request_tls(CONFIG_HTTP_APP_HOST,
+                                    CONFIG_HTTP_APP_PORT,
+                                    &req,
+                                    HTTP_TIMEOUT_MS,
+                                    &stream);
+#else
+        ret = http_pool_request(CONFIG_HTTP_APP_HOST,
+                                CONFIG_HTTP_APP_PORT,
+                                &req,
+                                HTTP_TIMEOUT_MS,
+                                &stream);
+#endif
+        ret = http_stream_end(&stream, ret);
+        ms = (uint32_t)(k_uptime_get() - start);
+
+        if (ret < 0) {
+            printk("Error (%d): HTTP request failed\r\n", ret);
+        } else {
+            printk("Request %d: %u body bytes, CRC32 0x%08x, %u ms, %u kB/s\r\n",
+                   i,
+                   (uint32_t)crc_sink.len,
+                   crc_sink.crc,
+                   ms,
+                   (uint32_t)(crc_sink.len / MAX(ms, 1)));
+        }
+        print_pool_stats();
+        print_dns_stats();
+
+        k_msleep(CONFIG_HTTP_APP_PERIOD_MS);
     }
 
-    // Close the socket
-    zsock_close(sock);
+    // Close the pooled sockets
+    http_pool_close_all();
 
     // Do nothing
     while (1) {
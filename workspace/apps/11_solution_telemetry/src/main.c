@@ -0,0 +1,210 @@
+#include <stdio.h>
+#include <zephyr/kernel.h>
+#include <zephyr/drivers/sensor.h>
+
+// Custom libraries
+#include "http_pool.h"
+#include "telemetry.h"
+#ifdef CONFIG_TELEMETRY_STORE
+#include "sample_log.h"
+#endif
+#ifdef CONFIG_WIFI_CONN
+#include "wifi_conn.h"
+#endif
+
+// WiFi settings
+#define WIFI_SSID "MySSID"
+#define WIFI_PSK "MyPassword"
+
+// Telemetry channels
+#define CHANNEL_TEMP 0
+
+// Stack size settings
+#define SENSOR_THREAD_STACK_SIZE 1024
+
+// Use the MCP9808 if the board has one, else simulate a slow drift
+#define HAS_SENSOR DT_NODE_EXISTS(DT_ALIAS(my_mcp9808))
+
+// Define stack area for the sensor thread
+K_THREAD_STACK_DEFINE(sensor_stack, SENSOR_THREAD_STACK_SIZE);
+
+// Declare thread data struct
+static struct k_thread sensor_thread;
+
+// Collector for the batches
+static const struct telemetry_config telemetry_cfg = {
+    .host = CONFIG_TELEMETRY_APP_HOST,
+    .port = CONFIG_TELEMETRY_APP_PORT,
+    .path = CONFIG_TELEMETRY_APP_PATH,
+};
+
+// Read the temperature in millidegrees
+static int read_temperature(int32_t *milli)
+{
+#if HAS_SENSOR
+    static const struct device *const mcp = DEVICE_DT_GET(DT_ALIAS(my_mcp9808));
+    struct sensor_value temperature;
+    int ret;
+
+    // Fetch the value from the sensor into the device's data struct
+    ret = sensor_sample_fetch(mcp);
+    if (ret < 0) {
+        printk("Sample fetch error: %d\r\n", ret);
+        return ret;
+    }
+
+    // Copy the value from the device's data struct into the local variable
+    ret = sensor_channel_get(mcp, SENSOR_CHAN_AMBIENT_TEMP, &temperature);
+    if (ret < 0) {
+        printk("Channel get error: %d\r\n", ret);
+        return ret;
+    }
+    *milli = (int32_t)sensor_value_to_milli(&temperature);
+#else
+    static int32_t step;
+
+    // 20-25 degrees in a triangle wave
+    step = (step + 1) % 200;
+    *milli = 20000 + ((step < 100) ? step : (200 - step)) * 50;
+#endif
+
+    return 0;
+}
+
+#ifdef CONFIG_TELEMETRY_STORE
+// Flash cost of riding out outages: bytes programmed and erased per byte
+// stored, and how fast batches go in and come back out
+static void print_log_stats(void)
+{
+    struct sample_log_stats log;
+
+    sample_log_stats_get(&log);
+    printk("  Flash log: %u bytes stored, %u drained, %u pending, %u lost "
+           "(%u x %u-byte sectors, %u-byte batches)\r\n",
+           log.appended,
+           log.drained,
+           log.pending,
+           log.lost,
+           log.sector_count,
+           log.sector_size,
+           log.batch_len);
+    if (log.entries > 0) {
+        printk("  Write amplification %u.%02u, erase amplification %u.%02u, "
+               "%u B/s written, %u B/s read\r\n",
+               log.written / log.appended,
+               (log.written * 100 / log.appended) % 100,
+               log.erased / log.appended,
+               (log.erased * 100 / log.appended) % 100,
+               (uint32_t)((uint64_t)log.written * 1000000 / MAX(log.write_us, 1)),
+               (uint32_t)((uint64_t)log.drained * 1000000 / MAX(log.read_us, 1)));
+    }
+}
+#endif
+
+// Sensor thread entry point: every reading goes to the uploader
+void sensor_thread_start(void *arg1, void *arg2, void *arg3)
+{
+    int32_t milli;
+
+#if HAS_SENSOR
+    // Check if the MCP9808 has been initialized (init function called)
+    if (!device_is_ready(DEVICE_DT_GET(DT_ALIAS(my_mcp9808)))) {
+        printk("Sensor is not ready\r\n");
+        return;
+    }
+#endif
+
+    printk("Starting sensor thread\r\n");
+
+    while (1) {
+        k_msleep(CONFIG_TELEMETRY_APP_SAMPLE_MS);
+
+        if (read_temperature(&milli) == 0) {
+            telemetry_add(CHANNEL_TEMP, milli);
+        }
+    }
+}
+
+int main(void)
+{
+    struct telemetry_stats stats;
+    struct http_pool_stats pool;
+#ifdef CONFIG_WIFI_CONN
+    struct wifi_conn_stats link;
+#endif
+    int ret;
+
+    printk("Telemetry demo: one reading every %u ms, batches of %u\r\n",
+           CONFIG_TELEMETRY_APP_SAMPLE_MS,
+           CONFIG_TELEMETRY_BATCH_SAMPLES);
+
+    // Start the uploader, then the sensor thread feeding it. Both run
+    // before the network is up: samples wait in RAM (or flash) until then.
+    ret = telemetry_init(&telemetry_cfg);
+    if (ret < 0) {
+        printk("Error (%d): could not start telemetry\r\n", ret);
+        return 0;
+    }
+    k_thread_create(&sensor_thread,
+                    sensor_stack,
+                    K_THREAD_STACK_SIZEOF(sensor_stack),
+                    sensor_thread_start,
+                    NULL,
+                    NULL,
+                    NULL,
+                    8,
+                    0,
+                    K_NO_WAIT);
+
+#ifdef CONFIG_WIFI_CONN
+    // Initialize WiFi and start connecting (it reconnects on its own)
+    wifi_conn_init();
+    ret = wifi_conn_connect(WIFI_SSID, WIFI_PSK);
+    if (ret < 0) {
+        printk("Error (%d): WiFi connection failed\r\n", ret);
+    }
+#endif
+
+    // Per-sample cost: payload bytes, requests and TCP handshakes
+    while (1) {
+        k_msleep(CONFIG_TELEMETRY_APP_STATS_MS);
+
+        telemetry_stats_get(&stats);
+        http_pool_stats_get(&pool);
+        printk("Telemetry: %u samples, %u sent in %u batches, %u dropped, "
+               "%u failed uploads, %u stored in flash\r\n",
+               stats.samples,
+               stats.sent,
+               stats.batches,
+               stats.dropped,
+               stats.failures,
+               stats.stored);
+        if (stats.sent > 0) {
+            printk("  %u payload bytes (%u.%02u per sample), %u.%02u samples per "
+                   "request, %u handshakes, last upload %u ms\r\n",
+                   stats.payload_bytes,
+                   stats.payload_bytes / stats.sent,
+                   (stats.payload_bytes * 100 / stats.sent) % 100,
+                   stats.sent / MAX(pool.requests, 1),
+                   (stats.sent * 100 / MAX(pool.requests, 1)) % 100,
+                   pool.handshakes,
+                   stats.last_upload_ms);
+        }
+#ifdef CONFIG_TELEMETRY_STORE
+        print_log_stats();
+#endif
+#ifdef CONFIG_WIFI_CONN
+        wifi_conn_stats_get(&link);
+        printk("  WiFi %s: %u attempts (%u on cached AP), %u failed, %u drops, "
+               "last up in %u ms\r\n",
+               wifi_conn_is_connected() ? "up" : "down",
+               link.attempts,
+               link.fast_attempts,
+               link.failures,
+               link.drops,
+               link.last_up_ms);
+#endif
+    }
+
+    return 0;
+}
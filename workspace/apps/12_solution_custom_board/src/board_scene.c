@@ -0,0 +1,73 @@
+#include <zephyr/kernel.h>
+#include <lvgl.h>
+
+#include "board_scene.h"
+
+// Styles and points must outlive the screen setup (LVGL keeps pointers)
+static lv_style_t counter_label_style;
+static lv_style_t rect_style;
+static lv_style_t circle_style;
+static lv_point_t rect_points[5] = { {0, 0}, {120, 0}, {120, 20}, {0, 20}, {0, 0} };
+
+// Widgets updated every frame
+static lv_obj_t *counter_label;
+static lv_obj_t *circle;
+
+// Build the screen
+void board_scene_create(lv_obj_t *scr)
+{
+	lv_obj_t *hello_label;
+	lv_obj_t *rect;
+
+	// Create static label widget
+	hello_label = lv_label_create(scr);
+	lv_label_set_text(hello_label, "Hello, World!");
+	lv_obj_align(hello_label, LV_ALIGN_TOP_MID, 0, 5);
+
+	// Adjust style for counter label
+	lv_style_init(&counter_label_style);
+	lv_style_set_text_font(&counter_label_style, &lv_font_montserrat_20);
+
+	// Create dynamic label widget
+	counter_label = lv_label_create(scr);
+	lv_obj_add_style(counter_label, &counter_label_style, 0);
+	lv_obj_align(counter_label, LV_ALIGN_BOTTOM_MID, 0, 0);
+
+	// Set line style
+	lv_style_init(&rect_style);
+	lv_style_set_line_color(&rect_style, lv_color_hex(0x0000FF));
+	lv_style_set_line_width(&rect_style, 3);
+
+	// Create a rectangle out of lines
+	rect = lv_line_create(scr);
+	lv_obj_add_style(rect, &rect_style, 0);
+	lv_line_set_points(rect, rect_points, ARRAY_SIZE(rect_points));
+	lv_obj_align(rect, LV_ALIGN_TOP_MID, 0, 0);
+
+	// Set circle style
+	lv_style_init(&circle_style);
+	lv_style_set_radius(&circle_style, BOARD_SCENE_CIRCLE_RADIUS);
+	lv_style_set_bg_opa(&circle_style, LV_OPA_100);
+	lv_style_set_bg_color(&circle_style, lv_color_hex(0xFF0000));
+
+	// Create an object with the new style
+	circle = lv_obj_create(scr);
+	lv_obj_set_size(circle, BOARD_SCENE_CIRCLE_RADIUS * 2, BOARD_SCENE_CIRCLE_RADIUS * 2);
+	lv_obj_add_style(circle, &circle_style, 0);
+	lv_obj_align(circle, LV_ALIGN_LEFT_MID, 0, 0);
+}
+
+// Show a value on the counter label
+void board_scene_set_counter(uint32_t value)
+{
+	static char buf[11];
+
+	snprintk(buf, sizeof(buf), "%u", value);
+	lv_label_set_text(counter_label, buf);
+}
+
+// Move the circle
+void board_scene_set_circle_x(int32_t x)
+{
+	lv_obj_align(circle, LV_ALIGN_LEFT_MID, x, 0);
+}
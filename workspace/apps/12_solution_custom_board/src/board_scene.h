@@ -0,0 +1,19 @@
+#ifndef BOARD_SCENE_H_
+#define BOARD_SCENE_H_
+
+#include <stdint.h>
+#include <lvgl.h>
+
+#define BOARD_SCENE_CIRCLE_RADIUS 15
+
+// Build the screen: static label, line rectangle, counter label and a
+// styled circle object
+void board_scene_create(lv_obj_t *scr);
+
+// Show a value on the counter label
+void board_scene_set_counter(uint32_t value);
+
+// Move the circle's left edge to x (relative to the left middle)
+void board_scene_set_circle_x(int32_t x);
+
+#endif /* BOARD_SCENE_H_ */
@@ -0,0 +1,148 @@
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/init.h>
+#include <zephyr/timing/timing.h>
+
+#include "bench.h"
+
+#if defined(CONFIG_BOARD_NATIVE_SIM)
+
+// Implemented in bench_native.c (runner context)
+extern uint64_t bench_native_ns(void);
+
+uint64_t bench_cycles_get(void)
+{
+    return bench_native_ns();
+}
+
+uint64_t bench_cycles_hz(void)
+{
+    return 1000000000ULL;
+}
+
+#elif defined(CONFIG_TIMING_FUNCTIONS)
+
+// Start the architecture timing counter (e.g. CPU cycle counter) at boot
+static int bench_init(void)
+{
+    timing_init();
+    timing_start();
+
+    return 0;
+}
+
+SYS_INIT(bench_init, APPLICATION, CONFIG_APPLICATION_INIT_PRIORITY);
+
+uint64_t bench_cycles_get(void)
+{
+    return (uint64_t)timing_counter_get();
+}
+
+uint64_t bench_cycles_hz(void)
+{
+    return timing_freq_get();
+}
+
+#else
+
+uint64_t bench_cycles_get(void)
+{
+#ifdef CONFIG_TIMER_HAS_64BIT_CYCLE_COUNTER
+    return k_cycle_get_64();
+#else
+    return k_cycle_get_32();
+#endif
+}
+
+uint64_t bench_cycles_hz(void)
+{
+    return sys_clock_hw_cycles_per_sec();
+}
+
+#endif
+
+uint64_t bench_cycles_to_ns(uint64_t cycles)
+{
+    const uint64_t hz = bench_cycles_hz();
+
+    // Split into whole seconds and remainder so long spans do not overflow
+    return (cycles / hz) * 1000000000ULL +
+           ((cycles % hz) * 1000000000ULL) / hz;
+}
+
+// Clear a histogram and set the width of each bucket
+void bench_hist_init(struct bench_hist *hist, uint32_t bucket_width)
+{
+    memset(hist, 0, sizeof(*hist));
+    hist->bucket_width = MAX(bucket_width, 1);
+    hist->min = UINT32_MAX;
+}
+
+// Add one value
+void bench_hist_add(struct bench_hist *hist, uint32_t value)
+{
+    uint32_t idx = value / hist->bucket_width;
+
+    hist->buckets[MIN(idx, CONFIG_BENCH_HIST_BUCKETS - 1)]++;
+    hist->count++;
+    hist->sum += value;
+    hist->min = MIN(hist->min, value);
+    hist->max = MAX(hist->max, value);
+}
+
+// Get the value below which permille/1000 of the samples fall
+uint32_t bench_hist_percentile(const struct bench_hist *hist,
+                               uint32_t permille)
+{
+    const uint64_t target = ((uint64_t)hist->count * permille + 999) / 1000;
+    uint64_t seen = 0;
+
+    for (int i = 0; i < CONFIG_BENCH_HIST_BUCKETS - 1; i++) {
+        seen += hist->buckets[i];
+        if ((seen >= target) && (seen > 0)) {
+            return MIN((i + 1) * hist->bucket_width, hist->max);
+        }
+    }
+
+    return hist->max;
+}
+
+// Print summary statistics and the non-empty buckets
+void bench_hist_print(const struct bench_hist *hist,
+                      const char *name,
+                      const char *unit)
+{
+    if (hist->count == 0) {
+        printk("%s: no samples\r\n", name);
+        return;
+    }
+
+    printk("%s: n=%u min=%u avg=%u p50=%u p90=%u p99=%u p99.9=%u max=%u %s\r\n",
+           name,
+           hist->count,
+           hist->min,
+           (uint32_t)(hist->sum / hist->count),
+           bench_hist_percentile(hist, 500),
+           bench_hist_percentile(hist, 900),
+           bench_hist_percentile(hist, 990),
+           bench_hist_percentile(hist, 999),
+           hist->max,
+           unit);
+
+    for (int i = 0; i < CONFIG_BENCH_HIST_BUCKETS; i++) {
+        if (hist->buckets[i] == 0) {
+            continue;
+        }
+        if (i == CONFIG_BENCH_HIST_BUCKETS - 1) {
+            printk("  >= %8u %s: %u\r\n",
+                   i * hist->bucket_width,
+                   unit,
+                   hist->buckets[i]);
+        } else {
+            printk("  <  %8u %s: %u\r\n",
+                   (i + 1) * hist->bucket_width,
+                   unit,
+                   hist->buckets[i]);
+        }
+    }
+}
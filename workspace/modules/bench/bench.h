@@ -0,0 +1,41 @@
+#ifndef BENCH_H_
+#define BENCH_H_
+
+#include <stdint.h>
+
+// Read the free-running benchmark counter
+uint64_t bench_cycles_get(void);
+
+// Get the benchmark counter frequency (Hz)
+uint64_t bench_cycles_hz(void);
+
+// Convert a counter delta to nanoseconds
+uint64_t bench_cycles_to_ns(uint64_t cycles);
+
+// Histogram with fixed-width buckets (one writer, e.g. a single ISR)
+struct bench_hist {
+    uint32_t bucket_width;
+    uint32_t buckets[CONFIG_BENCH_HIST_BUCKETS];
+    uint32_t count;
+    uint64_t sum;
+    uint32_t min;
+    uint32_t max;
+};
+
+// Clear a histogram and set the width of each bucket
+void bench_hist_init(struct bench_hist *hist, uint32_t bucket_width);
+
+// Add one value
+void bench_hist_add(struct bench_hist *hist, uint32_t value);
+
+// Get the value below which permille/1000 of the samples fall (upper edge
+// of the bucket, or the maximum if it lands in the last bucket)
+uint32_t bench_hist_percentile(const struct bench_hist *hist,
+                               uint32_t permille);
+
+// Print summary statistics and the non-empty buckets
+void bench_hist_print(const struct bench_hist *hist,
+                      const char *name,
+                      const char *unit);
+
+#endif /* BENCH_H_ */
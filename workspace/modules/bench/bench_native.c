@@ -0,0 +1,13 @@
+// Built in the native simulator runner context (host libc available)
+#include <stdint.h>
+#include <time.h>
+
+// Read the host's monotonic clock (ns)
+uint64_t bench_native_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
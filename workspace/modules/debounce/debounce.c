@@ -0,0 +1,231 @@
+#include <errno.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+
+#include "debounce.h"
+
+// Enable logging at CONFIG_LOG_DEFAULT_LEVEL
+LOG_MODULE_REGISTER(debounce);
+
+// GPIO port shared by one or more inputs (read with a single call)
+struct debounce_port {
+    const struct device *dev;
+    gpio_port_pins_t pins;
+    struct gpio_callback cb;
+};
+
+// Per-input integrator: counts up while the pin reads active and down while
+// it reads inactive. The stable state only flips at either end.
+struct debounce_pin {
+    uint8_t port_idx;
+    uint8_t integ;
+    uint8_t stable;
+};
+
+//------------------------------------------------------------------------------
+// Forward declarations
+
+static int port_add(const struct device *dev);
+static void debounce_isr(const struct device *dev,
+                         struct gpio_callback *cb,
+                         uint32_t pins);
+static void debounce_work_handler(struct k_work *work);
+
+//------------------------------------------------------------------------------
+// Globals
+
+static const struct gpio_dt_spec *specs;
+static size_t num_pins;
+static struct debounce_pin pins[CONFIG_DEBOUNCE_MAX_INPUTS];
+static struct debounce_port ports[CONFIG_DEBOUNCE_MAX_PORTS];
+static size_t num_ports;
+static debounce_handler_t event_handler;
+static void *event_user_data;
+
+// Dedicated workqueue and the single work item that samples every input
+K_THREAD_STACK_DEFINE(debounce_stack, CONFIG_DEBOUNCE_WORKQ_STACK_SIZE);
+static struct k_work_q debounce_workq;
+static struct k_work_delayable debounce_work;
+
+//------------------------------------------------------------------------------
+// Private functions
+
+// Find or add the port entry for a GPIO controller, returns its index
+static int port_add(const struct device *dev)
+{
+    for (size_t p = 0; p < num_ports; p++) {
+        if (ports[p].dev == dev) {
+            return p;
+        }
+    }
+
+    if (num_ports >= CONFIG_DEBOUNCE_MAX_PORTS) {
+        return -ENOMEM;
+    }
+    ports[num_ports].dev = dev;
+    ports[num_ports].pins = 0;
+
+    return num_ports++;
+}
+
+// GPIO callback (ISR): start sampling (no-op if already scheduled)
+static void debounce_isr(const struct device *dev,
+                         struct gpio_callback *cb,
+                         uint32_t pins)
+{
+    k_work_schedule_for_queue(&debounce_workq,
+                              &debounce_work,
+                              K_MSEC(CONFIG_DEBOUNCE_SAMPLE_MS));
+}
+
+// Work handler: read every port once, step every integrator and keep
+// sampling until all inputs have settled
+static void debounce_work_handler(struct k_work *work)
+{
+    gpio_port_value_t values[CONFIG_DEBOUNCE_MAX_PORTS];
+    bool read_ok[CONFIG_DEBOUNCE_MAX_PORTS];
+    bool settling = false;
+    int ret;
+
+    // Batch read: one call per port instead of one per pin
+    for (size_t p = 0; p < num_ports; p++) {
+        ret = gpio_port_get(ports[p].dev, &values[p]);
+        read_ok[p] = (ret >= 0);
+        if (!read_ok[p]) {
+            LOG_ERR("Error (%d): failed to read port %s", ret, ports[p].dev->name);
+            settling = true;
+        }
+    }
+
+    for (size_t i = 0; i < num_pins; i++) {
+        struct debounce_pin *pin = &pins[i];
+        int raw;
+
+        // Skip this sample for a port that could not be read: the
+        // integrators keep their state and the next sample retries
+        if (!read_ok[pin->port_idx]) {
+            continue;
+        }
+        raw = (values[pin->port_idx] & BIT(specs[i].pin)) ? 1 : 0;
+
+        // Step the integrator towards the raw reading
+        if (raw && (pin->integ < CONFIG_DEBOUNCE_INTEGRATOR_MAX)) {
+            pin->integ++;
+        } else if (!raw && (pin->integ > 0)) {
+            pin->integ--;
+        }
+
+        // Report a change once the integrator saturates
+        if ((pin->integ == CONFIG_DEBOUNCE_INTEGRATOR_MAX) && !pin->stable) {
+            pin->stable = 1;
+            event_handler(i, 1, event_user_data);
+        } else if ((pin->integ == 0) && pin->stable) {
+            pin->stable = 0;
+            event_handler(i, 0, event_user_data);
+        }
+
+        if ((pin->integ != 0) && (pin->integ != CONFIG_DEBOUNCE_INTEGRATOR_MAX)) {
+            settling = true;
+        }
+    }
+
+    // Go idle until the next edge once everything is stable
+    if (settling) {
+        k_work_schedule_for_queue(&debounce_workq,
+                                  &debounce_work,
+                                  K_MSEC(CONFIG_DEBOUNCE_SAMPLE_MS));
+    }
+}
+
+//------------------------------------------------------------------------------
+// Public functions (API)
+
+// Configure the inputs and start the service
+int debounce_init(const struct gpio_dt_spec *inputs,
+                  size_t num_inputs,
+                  debounce_handler_t handler,
+                  void *user_data)
+{
+    int ret;
+    int port_idx;
+
+    if ((num_inputs == 0) || (num_inputs > CONFIG_DEBOUNCE_MAX_INPUTS) ||
+        (handler == NULL)) {
+        return -EINVAL;
+    }
+
+    specs = inputs;
+    num_pins = num_inputs;
+    event_handler = handler;
+    event_user_data = user_data;
+    num_ports = 0;
+
+    // Configure each pin and group the pins by port
+    for (size_t i = 0; i < num_inputs; i++) {
+        const struct gpio_dt_spec *spec = &inputs[i];
+
+        if (!gpio_is_ready_dt(spec)) {
+            LOG_ERR("GPIO for input %u is not ready", (unsigned int)i);
+            return -ENODEV;
+        }
+
+        ret = gpio_pin_configure_dt(spec, GPIO_INPUT);
+        if (ret < 0) {
+            LOG_ERR("Error (%d): could not configure input %u", ret, (unsigned int)i);
+            return ret;
+        }
+
+        port_idx = port_add(spec->port);
+        if (port_idx < 0) {
+            LOG_ERR("Too many GPIO ports (CONFIG_DEBOUNCE_MAX_PORTS)");
+            return port_idx;
+        }
+        ports[port_idx].pins |= BIT(spec->pin);
+
+        // Start from the current level so nothing is reported at boot
+        pins[i].port_idx = port_idx;
+        pins[i].stable = (gpio_pin_get_dt(spec) > 0) ? 1 : 0;
+        pins[i].integ = pins[i].stable ? CONFIG_DEBOUNCE_INTEGRATOR_MAX : 0;
+    }
+
+    // Start the dedicated workqueue
+    k_work_init_delayable(&debounce_work, debounce_work_handler);
+    k_work_queue_init(&debounce_workq);
+    k_work_queue_start(&debounce_workq,
+                       debounce_stack,
+                       K_THREAD_STACK_SIZEOF(debounce_stack),
+                       CONFIG_DEBOUNCE_WORKQ_PRIORITY,
+                       NULL);
+    k_thread_name_set(&debounce_workq.thread, "debounce");
+
+    // One callback per port covers all of its pins
+    for (size_t p = 0; p < num_ports; p++) {
+        gpio_init_callback(&ports[p].cb, debounce_isr, ports[p].pins);
+        ret = gpio_add_callback(ports[p].dev, &ports[p].cb);
+        if (ret < 0) {
+            LOG_ERR("Error (%d): could not add callback", ret);
+            return ret;
+        }
+    }
+
+    // Interrupt on both edges: presses and releases both need debouncing
+    for (size_t i = 0; i < num_inputs; i++) {
+        ret = gpio_pin_interrupt_configure_dt(&inputs[i], GPIO_INT_EDGE_BOTH);
+        if (ret < 0) {
+            LOG_ERR("Error (%d): could not configure interrupt", ret);
+            return ret;
+        }
+    }
+
+    return 0;
+}
+
+// Get the debounced state of an input
+int debounce_state_get(size_t idx)
+{
+    if (idx >= num_pins) {
+        return -EINVAL;
+    }
+
+    return pins[idx].stable;
+}
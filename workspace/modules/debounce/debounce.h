@@ -0,0 +1,22 @@
+#ifndef DEBOUNCE_H_
+#define DEBOUNCE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <zephyr/drivers/gpio.h>
+
+// Stable state change event (runs on the debounce workqueue)
+typedef void (*debounce_handler_t)(size_t idx, int state, void *user_data);
+
+// Configure the inputs (as GPIO_INPUT with both-edge interrupts) and start
+// the service. idx in events is the position in the inputs array, which must
+// stay valid for as long as the service runs.
+int debounce_init(const struct gpio_dt_spec *inputs,
+                  size_t num_inputs,
+                  debounce_handler_t handler,
+                  void *user_data);
+
+// Get the debounced (logical) state of an input
+int debounce_state_get(size_t idx);
+
+#endif /* DEBOUNCE_H_ */
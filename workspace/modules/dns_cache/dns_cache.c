@@ -0,0 +1,414 @@
+#include <errno.h>
+#include <string.h>
+#include <zephyr/init.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/net/socket.h>
+
+#include "dns_cache.h"
+
+// Enable logging at CONFIG_LOG_DEFAULT_LEVEL
+LOG_MODULE_REGISTER(dns_cache);
+
+// Result of one query
+struct dns_result {
+    struct sockaddr_storage addrs[CONFIG_DNS_CACHE_ADDRS];
+    socklen_t addrlens[CONFIG_DNS_CACHE_ADDRS];
+    int num_addrs;
+    int status;
+};
+
+// One cached host name. While resolving is set the entry is owned by the
+// query in flight: it is not evicted, and callers wanting it wait on done.
+// Lookups return addrs[current]; each failed address moves it on by one.
+struct dns_entry {
+    char host[CONFIG_DNS_CACHE_HOST_MAX];
+    struct dns_result res;
+    int current;
+    int failed;
+    int64_t expires_ms;
+    int64_t last_used_ms;
+    bool valid;
+    bool resolving;
+    struct k_work refresh;
+};
+
+//------------------------------------------------------------------------------
+// Forward declarations
+
+static void query(const char *host, struct dns_result *res);
+static void entry_store(struct dns_entry *e, const struct dns_result *res);
+static struct dns_entry *entry_find(const char *host);
+static struct dns_entry *entry_alloc(const char *host);
+static int entry_copy(const struct dns_entry *e,
+                      uint16_t port,
+                      struct sockaddr_storage *addr,
+                      socklen_t *addrlen);
+static bool addr_equal(const struct sockaddr_storage *a,
+                       const struct sockaddr_storage *b);
+static void refresh_work_handler(struct k_work *work);
+static int dns_cache_init(void);
+
+//------------------------------------------------------------------------------
+// Globals
+
+static struct dns_entry entries[CONFIG_DNS_CACHE_ENTRIES];
+static K_MUTEX_DEFINE(cache_lock);
+static K_CONDVAR_DEFINE(query_done);
+static struct dns_cache_stats stats;
+
+// Prefetches run on their own queue: a query can block for seconds, which
+// must not hold up the system workqueue
+K_THREAD_STACK_DEFINE(dns_cache_stack, CONFIG_DNS_CACHE_WORKQ_STACK_SIZE);
+static struct k_work_q dns_cache_workq;
+
+SYS_INIT(dns_cache_init, APPLICATION, CONFIG_APPLICATION_INIT_PRIORITY);
+
+//------------------------------------------------------------------------------
+// Private functions
+
+// Run one query (without the lock held). Every address family is asked for,
+// in the order the resolver prefers, and the addrinfo list is always freed.
+static void query(const char *host, struct dns_result *res)
+{
+    struct zsock_addrinfo hints;
+    struct zsock_addrinfo *ai;
+    struct zsock_addrinfo *rp;
+    int ret;
+
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+
+    res->num_addrs = 0;
+    ret = zsock_getaddrinfo(host, NULL, &hints, &ai);
+    if (ret != 0) {
+        LOG_ERR("Error (%d): could not resolve %s", ret, host);
+        res->status = -EHOSTUNREACH;
+        return;
+    }
+
+    for (rp = ai; (rp != NULL) && (res->num_addrs < CONFIG_DNS_CACHE_ADDRS); rp = rp->ai_next) {
+        if (rp->ai_addrlen > sizeof(res->addrs[0])) {
+            continue;
+        }
+        memcpy(&res->addrs[res->num_addrs], rp->ai_addr, rp->ai_addrlen);
+        res->addrlens[res->num_addrs] = rp->ai_addrlen;
+        res->num_addrs++;
+    }
+    zsock_freeaddrinfo(ai);
+
+    res->status = (res->num_addrs > 0) ? 0 : -EHOSTUNREACH;
+}
+
+// Store a query result and wake everyone waiting for it (lock held). A
+// failed refresh keeps the old addresses until they expire.
+static void entry_store(struct dns_entry *e, const struct dns_result *res)
+{
+    int64_t now = k_uptime_get();
+
+    if (res->status == 0) {
+        e->res = *res;
+        e->current = 0;
+        e->failed = 0;
+        e->expires_ms = now + (CONFIG_DNS_CACHE_TTL_S * MSEC_PER_SEC);
+        e->valid = true;
+    } else {
+        stats.failures++;
+        if (!e->valid || (now >= e->expires_ms)) {
+            e->res = *res;
+            e->current = 0;
+            e->failed = 0;
+            e->expires_ms = now + (CONFIG_DNS_CACHE_NEGATIVE_TTL_S * MSEC_PER_SEC);
+            e->valid = (CONFIG_DNS_CACHE_NEGATIVE_TTL_S > 0);
+        }
+    }
+    e->resolving = false;
+    k_condvar_broadcast(&query_done);
+}
+
+// Find the entry for host (lock held)
+static struct dns_entry *entry_find(const char *host)
+{
+    for (int i = 0; i < CONFIG_DNS_CACHE_ENTRIES; i++) {
+        if ((entries[i].valid || entries[i].resolving) &&
+            (strcmp(entries[i].host, host) == 0)) {
+            return &entries[i];
+        }
+    }
+
+    return NULL;
+}
+
+// Take an unused entry for host, else the least recently used one that is
+// not being resolved (lock held). Returns NULL if every entry is busy.
+static struct dns_entry *entry_alloc(const char *host)
+{
+    struct dns_entry *e = NULL;
+
+    for (int i = 0; i < CONFIG_DNS_CACHE_ENTRIES; i++) {
+        if (entries[i].resolving) {
+            continue;
+        }
+        if (!entries[i].valid) {
+            e = &entries[i];
+            break;
+        }
+        if ((e == NULL) || (entries[i].last_used_ms < e->last_used_ms)) {
+            e = &entries[i];
+        }
+    }
+
+    if (e != NULL) {
+        strncpy(e->host, host, sizeof(e->host) - 1);
+        e->host[sizeof(e->host) - 1] = '\0';
+        e->valid = false;
+        e->last_used_ms = k_uptime_get();
+    }
+
+    return e;
+}
+
+// Copy an entry's current address out with the port set (lock held)
+static int entry_copy(const struct dns_entry *e,
+                      uint16_t port,
+                      struct sockaddr_storage *addr,
+                      socklen_t *addrlen)
+{
+    if (e->res.status < 0) {
+        return e->res.status;
+    }
+
+    memcpy(addr, &e->res.addrs[e->current], e->res.addrlens[e->current]);
+    *addrlen = e->res.addrlens[e->current];
+    if (addr->ss_family == AF_INET) {
+        net_sin((struct sockaddr *)addr)->sin_port = htons(port);
+    } else if (addr->ss_family == AF_INET6) {
+        net_sin6((struct sockaddr *)addr)->sin6_port = htons(port);
+    }
+
+    return 0;
+}
+
+// Compare the host part of two addresses (ports are ignored)
+static bool addr_equal(const struct sockaddr_storage *a,
+                       const struct sockaddr_storage *b)
+{
+    if (a->ss_family != b->ss_family) {
+        return false;
+    }
+    if (a->ss_family == AF_INET) {
+        return net_ipv4_addr_cmp(&net_sin((struct sockaddr *)a)->sin_addr,
+                                 &net_sin((struct sockaddr *)b)->sin_addr);
+    }
+    if (a->ss_family == AF_INET6) {
+        return net_ipv6_addr_cmp(&net_sin6((struct sockaddr *)a)->sin6_addr,
+                                 &net_sin6((struct sockaddr *)b)->sin6_addr);
+    }
+
+    return false;
+}
+
+// Background refresh of one entry (prefetch workqueue)
+static void refresh_work_handler(struct k_work *work)
+{
+    struct dns_entry *e = CONTAINER_OF(work, struct dns_entry, refresh);
+    struct dns_result res;
+
+    // The host name cannot change while resolving is set
+    query(e->host, &res);
+
+    k_mutex_lock(&cache_lock, K_FOREVER);
+    stats.prefetches++;
+    entry_store(e, &res);
+    k_mutex_unlock(&cache_lock);
+}
+
+// Start the prefetch workqueue
+static int dns_cache_init(void)
+{
+    for (int i = 0; i < CONFIG_DNS_CACHE_ENTRIES; i++) {
+        k_work_init(&entries[i].refresh, refresh_work_handler);
+    }
+
+    k_work_queue_init(&dns_cache_workq);
+    k_work_queue_start(&dns_cache_workq,
+                       dns_cache_stack,
+                       K_THREAD_STACK_SIZEOF(dns_cache_stack),
+                       CONFIG_DNS_CACHE_WORKQ_PRIORITY,
+                       NULL);
+    k_thread_name_set(&dns_cache_workq.thread, "dns_cache");
+
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+// Public functions (API)
+
+// Resolve host, from the cache if possible
+int dns_cache_resolve(const char *host,
+                      uint16_t port,
+                      struct sockaddr_storage *addr,
+                      socklen_t *addrlen)
+{
+    struct dns_entry *e;
+    struct dns_result res;
+    bool waited = false;
+    int64_t now;
+    int ret;
+
+    if (strlen(host) >= CONFIG_DNS_CACHE_HOST_MAX) {
+        return -ENAMETOOLONG;
+    }
+
+    k_mutex_lock(&cache_lock, K_FOREVER);
+    stats.lookups++;
+
+    while (1) {
+        now = k_uptime_get();
+        e = entry_find(host);
+
+        // Cached (or known to fail): answer now, refresh busy names early
+        if ((e != NULL) && e->valid && (now < e->expires_ms)) {
+            if (!waited) {
+                stats.hits++;
+            }
+            e->last_used_ms = now;
+            if ((CONFIG_DNS_CACHE_PREFETCH_S > 0) &&
+                !e->resolving &&
+                (e->res.status == 0) &&
+                ((e->expires_ms - now) < (CONFIG_DNS_CACHE_PREFETCH_S * MSEC_PER_SEC))) {
+                e->resolving = true;
+                k_work_submit_to_queue(&dns_cache_workq, &e->refresh);
+            }
+            ret = entry_copy(e, port, addr, addrlen);
+            k_mutex_unlock(&cache_lock);
+            return ret;
+        }
+
+        // Someone else is already asking: wait for their answer
+        if ((e != NULL) && e->resolving) {
+            if (!waited) {
+                stats.coalesced++;
+                waited = true;
+            }
+            k_condvar_wait(&query_done, &cache_lock, K_FOREVER);
+            continue;
+        }
+
+        if (e != NULL) {
+            stats.expired++;
+        } else {
+            e = entry_alloc(host);
+            if (e == NULL) {
+
+                // Every entry has a query in flight, try again after one ends
+                k_condvar_wait(&query_done, &cache_lock, K_FOREVER);
+                continue;
+            }
+        }
+        break;
+    }
+
+    // Query without the lock so other names are still served meanwhile
+    stats.misses++;
+    e->resolving = true;
+    k_mutex_unlock(&cache_lock);
+
+    query(e->host, &res);
+
+    k_mutex_lock(&cache_lock, K_FOREVER);
+    entry_store(e, &res);
+    ret = entry_copy(e, port, addr, addrlen);
+    k_mutex_unlock(&cache_lock);
+
+    return ret;
+}
+
+// Resolve host in the background unless it is cached and not about to expire
+int dns_cache_prefetch(const char *host)
+{
+    struct dns_entry *e;
+    int64_t now;
+    int ret = 0;
+
+    if (strlen(host) >= CONFIG_DNS_CACHE_HOST_MAX) {
+        return -ENAMETOOLONG;
+    }
+
+    k_mutex_lock(&cache_lock, K_FOREVER);
+
+    now = k_uptime_get();
+    e = entry_find(host);
+    if ((e != NULL) &&
+        (e->resolving ||
+         (e->valid && ((e->expires_ms - now) >= (CONFIG_DNS_CACHE_PREFETCH_S * MSEC_PER_SEC))))) {
+        k_mutex_unlock(&cache_lock);
+        return 0;
+    }
+
+    if (e == NULL) {
+        e = entry_alloc(host);
+    }
+    if (e != NULL) {
+        e->resolving = true;
+        k_work_submit_to_queue(&dns_cache_workq, &e->refresh);
+    } else {
+        ret = -EBUSY;
+    }
+
+    k_mutex_unlock(&cache_lock);
+
+    return ret;
+}
+
+// Drop host from the cache (a query in flight still completes)
+void dns_cache_invalidate(const char *host)
+{
+    struct dns_entry *e;
+
+    k_mutex_lock(&cache_lock, K_FOREVER);
+    e = entry_find(host);
+    if ((e != NULL) && e->valid) {
+        e->valid = false;
+        stats.invalidated++;
+    }
+    k_mutex_unlock(&cache_lock);
+}
+
+// Move host on to its next address after addr failed. Another caller may
+// already have moved on from addr, so only the current address counts.
+int dns_cache_addr_failed(const char *host, const struct sockaddr_storage *addr)
+{
+    struct dns_entry *e;
+    int ret = -ENOENT;
+
+    k_mutex_lock(&cache_lock, K_FOREVER);
+    e = entry_find(host);
+    if ((e != NULL) && e->valid && (e->res.status == 0)) {
+        if (addr_equal(&e->res.addrs[e->current], addr)) {
+            e->failed++;
+            e->current = (e->current + 1) % e->res.num_addrs;
+
+            // Every address failed since the last query: ask again next time
+            if (e->failed >= e->res.num_addrs) {
+                e->valid = false;
+                stats.invalidated++;
+            } else {
+                stats.failovers++;
+            }
+        }
+        ret = e->valid ? 0 : -ENOENT;
+    }
+    k_mutex_unlock(&cache_lock);
+
+    return ret;
+}
+
+// Get a snapshot of the cache counters
+void dns_cache_stats_get(struct dns_cache_stats *stats_out)
+{
+    k_mutex_lock(&cache_lock, K_FOREVER);
+    *stats_out = stats;
+    k_mutex_unlock(&cache_lock);
+}
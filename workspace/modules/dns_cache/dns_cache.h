@@ -0,0 +1,45 @@
+#ifndef DNS_CACHE_H_
+#define DNS_CACHE_H_
+
+#include <stdint.h>
+#include <zephyr/net/socket.h>
+
+// Cache counters
+struct dns_cache_stats {
+    uint32_t lookups;       // dns_cache_resolve() calls
+    uint32_t hits;          // Answered from the cache
+    uint32_t misses;        // Waited for a query
+    uint32_t coalesced;     // Waited for a query another caller started
+    uint32_t prefetches;    // Background refreshes
+    uint32_t expired;       // Entries found past their lifetime
+    uint32_t failures;      // Queries that returned no address
+    uint32_t invalidated;   // Entries dropped by dns_cache_invalidate()
+    uint32_t failovers;     // Moved on to a host's next address
+};
+
+// Resolve host to its current address with the given port, from the cache
+// if possible. That is the first address of the last query until
+// dns_cache_addr_failed() moves on. Blocks while a query for host is running
+// (started by this or another caller). Returns 0 on success or a negative
+// error code.
+int dns_cache_resolve(const char *host,
+                      uint16_t port,
+                      struct sockaddr_storage *addr,
+                      socklen_t *addrlen);
+
+// Start resolving host in the background if it is not cached (or is about
+// to expire), e.g. as soon as the network is up. Does not block.
+int dns_cache_prefetch(const char *host);
+
+// Drop host from the cache
+void dns_cache_invalidate(const char *host);
+
+// Report that connecting to addr, as returned for host, failed. Later
+// lookups return the host's next address. Returns 0 if there is one to try,
+// or -ENOENT once every address has failed and host was dropped.
+int dns_cache_addr_failed(const char *host, const struct sockaddr_storage *addr);
+
+// Get a snapshot of the cache counters
+void dns_cache_stats_get(struct dns_cache_stats *stats);
+
+#endif /* DNS_CACHE_H_ */
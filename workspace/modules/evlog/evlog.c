@@ -0,0 +1,185 @@
+#include <zephyr/kernel.h>
+#include <zephyr/init.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/util.h>
+
+#include "evlog.h"
+
+BUILD_ASSERT(IS_POWER_OF_TWO(CONFIG_EVLOG_BUFFER_SIZE),
+             "CONFIG_EVLOG_BUFFER_SIZE must be a power of two");
+
+#define EVLOG_MASK (CONFIG_EVLOG_BUFFER_SIZE - 1)
+
+// Ring slot: the sequence number says who owns the slot. A slot at position
+// pos is free for a writer when seq == pos, holds a committed record when
+// seq == pos + 1 and is handed back to writers with seq = pos + size.
+struct evlog_slot {
+    atomic_t seq;
+    struct evlog_record rec;
+};
+
+//------------------------------------------------------------------------------
+// Forward declarations
+
+static int evlog_init(void);
+static inline long seq_diff(atomic_val_t a, atomic_val_t b);
+static void evlog_print(const struct evlog_record *rec);
+static void evlog_thread_start(void *arg1, void *arg2, void *arg3);
+
+//------------------------------------------------------------------------------
+// Globals
+
+static struct evlog_slot slots[CONFIG_EVLOG_BUFFER_SIZE];
+static atomic_t head;           // Next position to reserve (writers)
+static atomic_val_t tail;       // Next position to read (flush side only)
+static atomic_t dropped;
+static uint32_t dropped_reported;
+
+// Event descriptions, indexed by record ID
+STRUCT_SECTION_START_EXTERN(evlog_event);
+
+// Only one reader at a time (flush thread or evlog_flush())
+static K_MUTEX_DEFINE(reader_lock);
+
+K_THREAD_DEFINE(evlog_thread,
+                CONFIG_EVLOG_THREAD_STACK_SIZE,
+                evlog_thread_start,
+                NULL,
+                NULL,
+                NULL,
+                CONFIG_EVLOG_THREAD_PRIORITY,
+                0,
+                0);
+
+//------------------------------------------------------------------------------
+// Private functions
+
+// Hand every slot to the writers before the first interrupt can fire
+static int evlog_init(void)
+{
+    for (int i = 0; i < CONFIG_EVLOG_BUFFER_SIZE; i++) {
+        atomic_set(&slots[i].seq, i);
+    }
+
+    return 0;
+}
+
+SYS_INIT(evlog_init, PRE_KERNEL_1, CONFIG_KERNEL_INIT_PRIORITY_DEFAULT);
+
+// Signed distance between two free-running positions (wrap-safe)
+static inline long seq_diff(atomic_val_t a, atomic_val_t b)
+{
+    return (long)((unsigned long)a - (unsigned long)b);
+}
+
+// Format one record (runs in thread context)
+static void evlog_print(const struct evlog_record *rec)
+{
+    const struct evlog_event *ev;
+    int count;
+
+    STRUCT_SECTION_COUNT(evlog_event, &count);
+    if (rec->id >= count) {
+        printk("[%10u us] <unknown event %u>\r\n",
+               k_cyc_to_us_floor32(rec->timestamp),
+               rec->id);
+        return;
+    }
+    STRUCT_SECTION_GET(evlog_event, rec->id, &ev);
+
+    printk("[%10u us] %s: ", k_cyc_to_us_floor32(rec->timestamp), ev->name);
+    printk(ev->fmt, rec->args[0], rec->args[1]);
+    printk("\r\n");
+}
+
+// Flush thread entry point
+static void evlog_thread_start(void *arg1, void *arg2, void *arg3)
+{
+    while (1) {
+        evlog_flush();
+        k_msleep(CONFIG_EVLOG_FLUSH_INTERVAL_MS);
+    }
+}
+
+//------------------------------------------------------------------------------
+// Public functions (API)
+
+// Append a record to the log (lock-free, callable from any ISR or thread)
+void evlog_write(const struct evlog_event *ev,
+                 uint8_t nargs,
+                 uint32_t arg0,
+                 uint32_t arg1)
+{
+    const uint32_t now = k_cycle_get_32();
+    struct evlog_slot *slot;
+    atomic_val_t pos;
+    long diff;
+
+    // Reserve a slot. A nested ISR may win the race, in which case retry
+    // with the position it left behind.
+    pos = atomic_get(&head);
+    while (1) {
+        slot = &slots[pos & EVLOG_MASK];
+        diff = seq_diff(atomic_get(&slot->seq), pos);
+        if (diff == 0) {
+            if (atomic_cas(&head, pos, pos + 1)) {
+                break;
+            }
+        } else if (diff < 0) {
+
+            // Slot still holds an unread record: ring is full
+            atomic_inc(&dropped);
+            return;
+        }
+        pos = atomic_get(&head);
+    }
+
+    // Fill in the record, then publish it to the reader
+    slot->rec.timestamp = now;
+    slot->rec.id = (uint16_t)(ev - STRUCT_SECTION_START(evlog_event));
+    slot->rec.nargs = nargs;
+    slot->rec.args[0] = arg0;
+    slot->rec.args[1] = arg1;
+    atomic_set(&slot->seq, pos + 1);
+}
+
+// Get the number of records dropped because the ring was full
+uint32_t evlog_dropped_get(void)
+{
+    return (uint32_t)atomic_get(&dropped);
+}
+
+// Print all committed records in order
+void evlog_flush(void)
+{
+    struct evlog_slot *slot;
+    struct evlog_record rec;
+    uint32_t lost;
+
+    k_mutex_lock(&reader_lock, K_FOREVER);
+
+    while (1) {
+
+        // Stop at the first slot that is empty or still being written
+        slot = &slots[tail & EVLOG_MASK];
+        if (seq_diff(atomic_get(&slot->seq), tail + 1) != 0) {
+            break;
+        }
+
+        // Copy the record out and give the slot back to writers right away
+        rec = slot->rec;
+        atomic_set(&slot->seq, tail + CONFIG_EVLOG_BUFFER_SIZE);
+        tail++;
+
+        evlog_print(&rec);
+    }
+
+    // Report drops since the last flush
+    lost = evlog_dropped_get();
+    if (lost != dropped_reported) {
+        printk("evlog: %u records dropped\r\n", lost - dropped_reported);
+        dropped_reported = lost;
+    }
+
+    k_mutex_unlock(&reader_lock);
+}
@@ -0,0 +1,57 @@
+#ifndef EVLOG_H_
+#define EVLOG_H_
+
+#include <stdint.h>
+#include <zephyr/sys/iterable_sections.h>
+
+// Number of arguments stored with each record
+#define EVLOG_MAX_ARGS 2
+
+// Event description, stored in ROM. Records only carry its index (ID).
+struct evlog_event {
+    const char *name;
+    const char *fmt;
+};
+
+// Binary record written by the ISR (16 bytes)
+struct evlog_record {
+    uint32_t timestamp;
+    uint16_t id;
+    uint8_t nargs;
+    uint8_t reserved;
+    uint32_t args[EVLOG_MAX_ARGS];
+};
+
+// Define an event, e.g. EVLOG_EVENT_DEFINE(alarm, "ticks=%u");
+// fmt is a printk format string for up to EVLOG_MAX_ARGS uint32_t arguments
+#define EVLOG_EVENT_DEFINE(_name, _fmt)                                     \
+    const STRUCT_SECTION_ITERABLE(evlog_event, evlog_event_##_name) = {     \
+        .name = #_name,                                                     \
+        .fmt = _fmt,                                                        \
+    }
+
+// Declare an event defined in another file
+#define EVLOG_EVENT_DECLARE(_name)                                          \
+    extern const struct evlog_event evlog_event_##_name
+
+// Log an event with zero, one or two arguments (safe to call from ISRs)
+#define EVLOG0(_name)                                                       \
+    evlog_write(&evlog_event_##_name, 0, 0, 0)
+#define EVLOG1(_name, _a0)                                                  \
+    evlog_write(&evlog_event_##_name, 1, (uint32_t)(_a0), 0)
+#define EVLOG2(_name, _a0, _a1)                                             \
+    evlog_write(&evlog_event_##_name, 2, (uint32_t)(_a0), (uint32_t)(_a1))
+
+// Append a record to the log (lock-free, never blocks)
+void evlog_write(const struct evlog_event *ev,
+                 uint8_t nargs,
+                 uint32_t arg0,
+                 uint32_t arg1);
+
+// Get the number of records dropped because the ring was full
+uint32_t evlog_dropped_get(void);
+
+// Print all pending records now (call from thread context only)
+void evlog_flush(void);
+
+#endif /* EVLOG_H_ */
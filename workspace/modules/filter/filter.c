@@ -0,0 +1,183 @@
+#include <errno.h>
+#include <string.h>
+
+#include "filter.h"
+
+//------------------------------------------------------------------------------
+// Forward declarations
+
+static inline uint16_t median_select(const uint16_t *restrict win, uint8_t n);
+
+//------------------------------------------------------------------------------
+// Private functions
+
+// Select the median of the window without branches: every element gets a
+// unique rank (ties broken by position) and the one ranked n/2 wins. The
+// inner loop is a compare-and-accumulate that the compiler can vectorize.
+static inline uint16_t median_select(const uint16_t *restrict win, uint8_t n)
+{
+    const uint8_t half = n / 2;
+    uint16_t med = win[0];
+
+    for (uint8_t i = 0; i < n; i++) {
+        const uint16_t v = win[i];
+        uint8_t rank = 0;
+
+        for (uint8_t j = 0; j < n; j++) {
+            rank += (win[j] < v) | ((j < i) & (win[j] == v));
+        }
+        med = (rank == half) ? v : med;
+    }
+
+    return med;
+}
+
+//------------------------------------------------------------------------------
+// Public functions (API)
+
+// Initialize a median filter with the window pre-filled with initial
+int filter_median_init(struct filter_median *f, uint8_t n, uint16_t initial)
+{
+    if ((n == 0) || ((n & 1) == 0) || (n > FILTER_MEDIAN_MAX_N)) {
+        return -EINVAL;
+    }
+
+    for (uint8_t i = 0; i < FILTER_MEDIAN_MAX_N; i++) {
+        f->win[i] = initial;
+    }
+    f->n = n;
+    f->idx = 0;
+
+    return 0;
+}
+
+// Filter a buffer (in and out may be the same buffer)
+void filter_median_process(struct filter_median *f,
+                           const uint16_t *in,
+                           uint16_t *out,
+                           size_t len)
+{
+    const uint8_t n = f->n;
+    uint8_t idx = f->idx;
+
+    for (size_t k = 0; k < len; k++) {
+
+        // Replace the oldest sample in the window
+        f->win[idx] = in[k];
+        idx = (idx + 1 == n) ? 0 : idx + 1;
+
+        out[k] = median_select(f->win, n);
+    }
+
+    f->idx = idx;
+}
+
+// Initialize an IIR filter (the first sample seeds the output)
+int filter_iir_init(struct filter_iir *f, uint8_t shift)
+{
+    if (shift > FILTER_IIR_FRAC_BITS) {
+        return -EINVAL;
+    }
+
+    f->acc = 0;
+    f->shift = shift;
+    f->primed = 0;
+
+    return 0;
+}
+
+// Filter a buffer (in and out may be the same buffer)
+void filter_iir_process(struct filter_iir *f,
+                        const uint16_t *in,
+                        uint16_t *out,
+                        size_t len)
+{
+    const uint8_t shift = f->shift;
+    const int32_t round = 1 << (FILTER_IIR_FRAC_BITS - 1);
+    int32_t acc = f->acc;
+
+    if (len == 0) {
+        return;
+    }
+
+    // Start from the first sample instead of ramping up from zero
+    if (!f->primed) {
+        acc = (int32_t)in[0] << FILTER_IIR_FRAC_BITS;
+        f->primed = 1;
+    }
+
+    // Keep the accumulator in a register; each output depends on the last
+    for (size_t k = 0; k < len; k++) {
+        acc += (((int32_t)in[k] << FILTER_IIR_FRAC_BITS) - acc) >> shift;
+        out[k] = (uint16_t)((acc + round) >> FILTER_IIR_FRAC_BITS);
+    }
+
+    f->acc = acc;
+}
+
+// Initialize a CIC decimator
+int filter_cic_init(struct filter_cic *f, uint8_t order, uint16_t decimation)
+{
+    uint8_t log2_r = 0;
+
+    // Decimation must be a power of two (gain is removed with a shift)
+    if ((decimation < 2) || (decimation & (decimation - 1))) {
+        return -EINVAL;
+    }
+    while ((1U << log2_r) < decimation) {
+        log2_r++;
+    }
+
+    // Register growth is order * log2(R) bits on top of the 16-bit input
+    if ((order == 0) || (order > FILTER_CIC_MAX_ORDER) ||
+        (order * log2_r > 16)) {
+        return -EINVAL;
+    }
+
+    memset(f, 0, sizeof(*f));
+    f->order = order;
+    f->log2_r = log2_r;
+
+    return 0;
+}
+
+// Decimate a buffer, returns the number of output samples written
+size_t filter_cic_process(struct filter_cic *f,
+                          const uint16_t *in,
+                          uint16_t *out,
+                          size_t len)
+{
+    const uint8_t order = f->order;
+    const uint8_t gain_shift = order * f->log2_r;
+    const uint16_t r_mask = (1U << f->log2_r) - 1;
+    uint16_t phase = f->phase;
+    size_t n_out = 0;
+
+    // Unsigned arithmetic wraps modulo 2^32, which is exactly what the
+    // integrators need: the combs cancel the overflow as long as the final
+    // result fits (guaranteed by the checks in filter_cic_init())
+    for (size_t k = 0; k < len; k++) {
+
+        // Integrator cascade runs at the input rate
+        uint32_t v = in[k];
+        for (uint8_t s = 0; s < order; s++) {
+            f->integ[s] += v;
+            v = f->integ[s];
+        }
+
+        // Comb cascade runs at the output rate
+        phase = (phase + 1) & r_mask;
+        if (phase == 0) {
+            for (uint8_t s = 0; s < order; s++) {
+                const uint32_t prev = f->comb[s];
+                f->comb[s] = v;
+                v -= prev;
+            }
+            out[n_out++] = (uint16_t)(v >> gain_shift);
+        }
+    }
+
+    f->phase = phase;
+
+    return n_out;
+}
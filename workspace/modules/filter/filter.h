@@ -0,0 +1,64 @@
+#ifndef FILTER_H_
+#define FILTER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Largest supported median window (must be odd)
+#define FILTER_MEDIAN_MAX_N 9
+
+// Fractional bits kept in the IIR accumulator (Q.12 fixed point)
+#define FILTER_IIR_FRAC_BITS 12
+
+// Largest supported CIC order (number of integrator/comb stages)
+#define FILTER_CIC_MAX_ORDER 4
+
+// Median-of-N filter state (sliding window over the last n samples)
+struct filter_median {
+    uint16_t win[FILTER_MEDIAN_MAX_N];
+    uint8_t n;
+    uint8_t idx;
+};
+
+// Single-pole IIR (exponential moving average) state:
+//  y[k] = y[k-1] + (x[k] - y[k-1]) / 2^shift
+struct filter_iir {
+    int32_t acc;
+    uint8_t shift;
+    uint8_t primed;
+};
+
+// CIC decimator state (differential delay of 1, decimation 2^log2_r)
+struct filter_cic {
+    uint32_t integ[FILTER_CIC_MAX_ORDER];
+    uint32_t comb[FILTER_CIC_MAX_ORDER];
+    uint8_t order;
+    uint8_t log2_r;
+    uint16_t phase;
+};
+
+// Median: n must be odd and no larger than FILTER_MEDIAN_MAX_N
+int filter_median_init(struct filter_median *f, uint8_t n, uint16_t initial);
+void filter_median_process(struct filter_median *f,
+                           const uint16_t *in,
+                           uint16_t *out,
+                           size_t len);
+
+// IIR: larger shift means heavier smoothing (time constant ~2^shift samples)
+int filter_iir_init(struct filter_iir *f, uint8_t shift);
+void filter_iir_process(struct filter_iir *f,
+                        const uint16_t *in,
+                        uint16_t *out,
+                        size_t len);
+
+// CIC: decimation must be a power of two and order * log2(decimation) must
+// not exceed 16 so the 32-bit registers cannot overflow for 16-bit input.
+// filter_cic_process() returns the number of samples written to out, which
+// is at most len / decimation + 1.
+int filter_cic_init(struct filter_cic *f, uint8_t order, uint16_t decimation);
+size_t filter_cic_process(struct filter_cic *f,
+                          const uint16_t *in,
+                          uint16_t *out,
+                          size_t len);
+
+#endif /* FILTER_H_ */
@@ -0,0 +1,479 @@
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/net/socket.h>
+#ifdef CONFIG_HTTP_POOL_TLS
+#include <zephyr/net/tls_credentials.h>
+#endif
+#if defined(CONFIG_MBEDTLS_ENABLE_HEAP) && defined(CONFIG_MBEDTLS_MEMORY_DEBUG)
+#include <mbedtls/memory_buffer_alloc.h>
+#endif
+
+#include "http_pool.h"
+#ifdef CONFIG_DNS_CACHE
+#include "dns_cache.h"
+#endif
+
+// Enable logging at CONFIG_LOG_DEFAULT_LEVEL
+LOG_MODULE_REGISTER(http_pool);
+
+// Longest port string ("65535")
+#define PORT_MAX 6
+
+// Addresses tried per connection attempt (the DNS cache keeps several)
+#ifdef CONFIG_DNS_CACHE
+#define CONN_ADDR_ATTEMPTS CONFIG_DNS_CACHE_ADDRS
+#else
+#define CONN_ADDR_ATTEMPTS 1
+#endif
+
+// Counters are bumped from whichever thread makes the request
+#define STAT_INC(field)                         \
+    do {                                        \
+        k_mutex_lock(&pool_lock, K_FOREVER);    \
+        stats.field++;                          \
+        k_mutex_unlock(&pool_lock);             \
+    } while (0)
+
+// One pooled connection. The resolved address is kept so reconnecting does
+// not need another DNS lookup; it is dropped if connecting to it fails.
+struct pool_conn {
+    char host[CONFIG_HTTP_POOL_HOST_MAX];
+    char port[PORT_MAX];
+    struct sockaddr_storage addr;
+    socklen_t addrlen;
+    bool have_addr;
+    bool tls;
+    int sock;
+    bool in_use;
+    int64_t last_used_ms;
+};
+
+//------------------------------------------------------------------------------
+// Forward declarations
+
+static void conn_close(struct pool_conn *c);
+static int conn_resolve(struct pool_conn *c);
+#ifdef CONFIG_HTTP_POOL_TLS
+static int conn_setup_tls(struct pool_conn *c);
+#endif
+static int conn_socket(struct pool_conn *c);
+static int conn_open(struct pool_conn *c);
+static bool conn_alive(struct pool_conn *c);
+static struct pool_conn *conn_acquire(const char *host, const char *port, bool tls);
+static void conn_release(struct pool_conn *c);
+static int pool_request(const char *host,
+                        const char *port,
+                        bool tls,
+                        struct http_request *req,
+                        int32_t timeout_ms,
+                        void *user_data);
+
+//------------------------------------------------------------------------------
+// Globals
+
+static struct pool_conn conns[CONFIG_HTTP_POOL_SIZE] = {
+    [0 ... CONFIG_HTTP_POOL_SIZE - 1] = { .sock = -1 },
+};
+static K_MUTEX_DEFINE(pool_lock);
+static struct http_pool_stats stats;
+
+//------------------------------------------------------------------------------
+// Private functions
+
+// Close a connection's socket (the entry and its address stay)
+static void conn_close(struct pool_conn *c)
+{
+    if (c->sock >= 0) {
+        zsock_close(c->sock);
+        c->sock = -1;
+    }
+}
+
+// Look up the connection's host and keep the first address
+static int conn_resolve(struct pool_conn *c)
+{
+#ifdef CONFIG_DNS_CACHE
+    int ret;
+
+    STAT_INC(dns_lookups);
+    ret = dns_cache_resolve(c->host,
+                            (uint16_t)strtoul(c->port, NULL, 10),
+                            &c->addr,
+                            &c->addrlen);
+    if (ret < 0) {
+        return ret;
+    }
+    c->have_addr = true;
+
+    return 0;
+#else
+    struct zsock_addrinfo hints;
+    struct zsock_addrinfo *res;
+    int ret;
+
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+
+    STAT_INC(dns_lookups);
+    ret = zsock_getaddrinfo(c->host, c->port, &hints, &res);
+    if (ret != 0) {
+        LOG_ERR("Error (%d): could not resolve %s", ret, c->host);
+        return -EHOSTUNREACH;
+    }
+
+    memcpy(&c->addr, res->ai_addr, MIN(res->ai_addrlen, sizeof(c->addr)));
+    c->addrlen = res->ai_addrlen;
+    c->have_addr = true;
+    zsock_freeaddrinfo(res);
+
+    return 0;
+#endif
+}
+
+#ifdef CONFIG_HTTP_POOL_TLS
+// TLS options for a new socket: SNI and certificate check for the host,
+// and the session cache so a reconnect resumes instead of starting over
+static int conn_setup_tls(struct pool_conn *c)
+{
+    static const sec_tag_t sec_tags[] = { CONFIG_HTTP_POOL_TLS_SEC_TAG };
+    int verify = IS_ENABLED(CONFIG_HTTP_POOL_TLS_VERIFY) ?
+                 TLS_PEER_VERIFY_REQUIRED : TLS_PEER_VERIFY_NONE;
+    int cache = TLS_SESSION_CACHE_ENABLED;
+    int ret;
+
+    ret = zsock_setsockopt(c->sock, SOL_TLS, TLS_HOSTNAME, c->host, strlen(c->host) + 1);
+    if ((ret == 0) && IS_ENABLED(CONFIG_HTTP_POOL_TLS_VERIFY)) {
+        ret = zsock_setsockopt(c->sock, SOL_TLS, TLS_SEC_TAG_LIST, sec_tags, sizeof(sec_tags));
+    }
+    if (ret == 0) {
+        ret = zsock_setsockopt(c->sock, SOL_TLS, TLS_PEER_VERIFY, &verify, sizeof(verify));
+    }
+    if (ret == 0) {
+        ret = zsock_setsockopt(c->sock, SOL_TLS, TLS_SESSION_CACHE, &cache, sizeof(cache));
+    }
+    if (ret < 0) {
+        ret = -errno;
+        LOG_ERR("Error (%d): could not set TLS options", ret);
+        return ret;
+    }
+
+    return 0;
+}
+#endif
+
+// Create the socket for the connection's current address (and set it up
+// for TLS if enabled)
+static int conn_socket(struct pool_conn *c)
+{
+    int proto = IPPROTO_TCP;
+    int ret;
+
+#ifdef CONFIG_HTTP_POOL_TLS
+    if (c->tls) {
+        proto = IPPROTO_TLS_1_2;
+    }
+#endif
+
+    c->sock = zsock_socket(c->addr.ss_family, SOCK_STREAM, proto);
+    if (c->sock < 0) {
+        ret = -errno;
+        LOG_ERR("Error (%d): could not create socket", ret);
+        return ret;
+    }
+
+#ifdef CONFIG_HTTP_POOL_TLS
+    if (c->tls) {
+        ret = conn_setup_tls(c);
+        if (ret < 0) {
+            conn_close(c);
+            return ret;
+        }
+    }
+#endif
+
+    return 0;
+}
+
+// Open a new TCP (or TLS) connection. With the DNS cache, an address that
+// refuses the connection is reported and the host's next address is tried.
+static int conn_open(struct pool_conn *c)
+{
+    int64_t start = 0;
+    uint32_t ms;
+    int ret = -EHOSTUNREACH;
+
+    for (int attempt = 0; attempt < CONN_ADDR_ATTEMPTS; attempt++) {
+
+        // The DNS cache is asked every time, it knows when an address expires
+        if (!c->have_addr || IS_ENABLED(CONFIG_DNS_CACHE)) {
+            ret = conn_resolve(c);
+            if (ret < 0) {
+                return ret;
+            }
+        }
+
+        ret = conn_socket(c);
+        if (ret < 0) {
+            return ret;
+        }
+
+        // For TLS sockets this runs the handshake too
+        STAT_INC(handshakes);
+        start = k_uptime_get();
+        ret = zsock_connect(c->sock, (struct sockaddr *)&c->addr, c->addrlen);
+        if (ret == 0) {
+            break;
+        }
+        ret = -errno;
+        LOG_ERR("Error (%d): could not connect to %s:%s", ret, c->host, c->port);
+        conn_close(c);
+
+        // The address may be stale: look it up again next time, or move on
+        // to the host's next cached address right away
+        c->have_addr = false;
+#ifdef CONFIG_DNS_CACHE
+        if (dns_cache_addr_failed(c->host, &c->addr) < 0) {
+            break;
+        }
+#endif
+    }
+    if (ret < 0) {
+        return ret;
+    }
+
+    if (c->tls) {
+        ms = (uint32_t)(k_uptime_get() - start);
+        k_mutex_lock(&pool_lock, K_FOREVER);
+        stats.tls_handshakes++;
+        stats.tls_last_ms = ms;
+        stats.tls_max_ms = MAX(stats.tls_max_ms, ms);
+        stats.tls_total_ms += ms;
+        k_mutex_unlock(&pool_lock);
+    }
+
+    return 0;
+}
+
+// Check an idle connection without blocking: a closed socket reads as end
+// of stream, a live one has nothing to read. Anything else (an error, or
+// data nobody asked for) also means it cannot be reused.
+static bool conn_alive(struct pool_conn *c)
+{
+    uint8_t byte;
+    ssize_t ret;
+
+    // Peeking a TLS socket would mean decrypting a record, so just check
+    // that nothing (close_notify, end of stream, an error) is waiting
+    if (c->tls) {
+        struct zsock_pollfd pfd = { .fd = c->sock, .events = ZSOCK_POLLIN };
+
+        if (zsock_poll(&pfd, 1, 0) == 0) {
+            return true;
+        }
+        STAT_INC(server_closed);
+        return false;
+    }
+
+    ret = zsock_recv(c->sock, &byte, 1, ZSOCK_MSG_PEEK | ZSOCK_MSG_DONTWAIT);
+    if ((ret < 0) && ((errno == EAGAIN) || (errno == EWOULDBLOCK))) {
+        return true;
+    }
+
+    if (ret == 0) {
+        STAT_INC(server_closed);
+    }
+
+    return false;
+}
+
+// Take a connection for host:port: an open one if there is one, else an
+// unused entry, else the least recently used idle entry for another host
+static struct pool_conn *conn_acquire(const char *host, const char *port, bool tls)
+{
+    struct pool_conn *match = NULL;
+    struct pool_conn *empty = NULL;
+    struct pool_conn *lru = NULL;
+    struct pool_conn *c;
+
+    k_mutex_lock(&pool_lock, K_FOREVER);
+
+    for (int i = 0; i < CONFIG_HTTP_POOL_SIZE; i++) {
+        c = &conns[i];
+        if (c->in_use) {
+            continue;
+        }
+        if ((strcmp(c->host, host) == 0) && (strcmp(c->port, port) == 0) && (c->tls == tls)) {
+            if ((match == NULL) || (c->sock >= 0)) {
+                match = c;
+            }
+        } else if (c->host[0] == '\0') {
+            empty = (empty == NULL) ? c : empty;
+        } else if ((lru == NULL) || (c->last_used_ms < lru->last_used_ms)) {
+            lru = c;
+        }
+    }
+
+    c = (match != NULL) ? match : ((empty != NULL) ? empty : lru);
+    if (c != NULL) {
+        if (c != match) {
+            conn_close(c);
+            strncpy(c->host, host, sizeof(c->host) - 1);
+            c->host[sizeof(c->host) - 1] = '\0';
+            strncpy(c->port, port, sizeof(c->port) - 1);
+            c->port[sizeof(c->port) - 1] = '\0';
+            c->tls = tls;
+            c->have_addr = false;
+        }
+        c->in_use = true;
+    }
+
+    k_mutex_unlock(&pool_lock);
+
+    return c;
+}
+
+// Hand a connection back to the pool
+static void conn_release(struct pool_conn *c)
+{
+    k_mutex_lock(&pool_lock, K_FOREVER);
+    c->last_used_ms = k_uptime_get();
+    c->in_use = false;
+    k_mutex_unlock(&pool_lock);
+}
+
+// Make a request on a pooled plain or TLS connection
+static int pool_request(const char *host,
+                        const char *port,
+                        bool tls,
+                        struct http_request *req,
+                        int32_t timeout_ms,
+                        void *user_data)
+{
+    struct pool_conn *c;
+    bool reused;
+    int ret;
+
+    if (strlen(host) >= CONFIG_HTTP_POOL_HOST_MAX) {
+        return -ENAMETOOLONG;
+    }
+
+    c = conn_acquire(host, port, tls);
+    if (c == NULL) {
+        return -EBUSY;
+    }
+    STAT_INC(requests);
+
+    for (int attempt = 0; attempt < 2; attempt++) {
+        reused = false;
+
+        // Drop idle connections the server has (or is about to have) closed
+        if ((c->sock >= 0) &&
+            ((k_uptime_get() - c->last_used_ms) > CONFIG_HTTP_POOL_IDLE_TIMEOUT_MS)) {
+            STAT_INC(expired);
+            conn_close(c);
+        }
+        if ((c->sock >= 0) && !conn_alive(c)) {
+            conn_close(c);
+        }
+
+        if (c->sock >= 0) {
+            reused = true;
+        } else {
+            ret = conn_open(c);
+            if (ret < 0) {
+                break;
+            }
+        }
+
+        ret = http_client_req(c->sock, req, timeout_ms, user_data);
+
+        // A request counts as done once the whole response has arrived
+        if ((ret >= 0) && req->internal.response.message_complete) {
+            if (reused) {
+                STAT_INC(reused);
+            }
+
+            // Honour "Connection: close" (and HTTP/1.0 servers)
+            if (!http_should_keep_alive(&req->internal.parser)) {
+                conn_close(c);
+            }
+            break;
+        }
+        conn_close(c);
+
+        // Only resend if the server closed a reused socket before sending
+        // anything back; a fresh connection failing is a real error
+        if (!reused || (req->internal.response.http_status_code != 0)) {
+            ret = (ret < 0) ? ret : -ECONNRESET;
+            break;
+        }
+        STAT_INC(retries);
+        ret = -ECONNRESET;
+    }
+
+    if (ret < 0) {
+        STAT_INC(errors);
+    }
+    conn_release(c);
+
+    return ret;
+}
+
+//------------------------------------------------------------------------------
+// Public functions (API)
+
+// Make a request on a pooled connection
+int http_pool_request(const char *host,
+                      const char *port,
+                      struct http_request *req,
+                      int32_t timeout_ms,
+                      void *user_data)
+{
+    return pool_request(host, port, false, req, timeout_ms, user_data);
+}
+
+#ifdef CONFIG_HTTP_POOL_TLS
+// Make a request on a pooled HTTPS connection
+int http_pool_request_tls(const char *host,
+                          const char *port,
+                          struct http_request *req,
+                          int32_t timeout_ms,
+                          void *user_data)
+{
+    return pool_request(host, port, true, req, timeout_ms, user_data);
+}
+#endif
+
+// Close every idle connection
+void http_pool_close_all(void)
+{
+    k_mutex_lock(&pool_lock, K_FOREVER);
+    for (int i = 0; i < CONFIG_HTTP_POOL_SIZE; i++) {
+        if (!conns[i].in_use) {
+            conn_close(&conns[i]);
+        }
+    }
+    k_mutex_unlock(&pool_lock);
+}
+
+// Get a snapshot of the pool counters
+void http_pool_stats_get(struct http_pool_stats *stats_out)
+{
+    k_mutex_lock(&pool_lock, K_FOREVER);
+    *stats_out = stats;
+    k_mutex_unlock(&pool_lock);
+
+#if defined(CONFIG_MBEDTLS_ENABLE_HEAP) && defined(CONFIG_MBEDTLS_MEMORY_DEBUG)
+    size_t used;
+    size_t blocks;
+
+    mbedtls_memory_buffer_alloc_cur_get(&used, &blocks);
+    stats_out->tls_heap_used = used;
+    mbedtls_memory_buffer_alloc_max_get(&used, &blocks);
+    stats_out->tls_heap_peak = used;
+#endif
+}
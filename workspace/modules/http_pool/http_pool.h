@@ -0,0 +1,52 @@
+#ifndef HTTP_POOL_H_
+#define HTTP_POOL_H_
+
+#include <stdint.h>
+#include <zephyr/net/http/client.h>
+
+// Pool counters
+struct http_pool_stats {
+    uint32_t requests;
+    uint32_t reused;        // Requests sent on an already open connection
+    uint32_t handshakes;    // TCP connections opened
+    uint32_t dns_lookups;   // Address lookups (answered by DNS_CACHE if enabled)
+    uint32_t server_closed; // Idle connections found closed by the server
+    uint32_t expired;       // Idle connections closed by the idle timeout
+    uint32_t retries;       // Requests resent after a reused socket failed
+    uint32_t errors;        // Requests that failed
+    uint32_t tls_handshakes;    // TLS connections opened (full or resumed)
+    uint32_t tls_last_ms;       // Connect time of the last one (TCP + TLS)
+    uint32_t tls_max_ms;
+    uint32_t tls_total_ms;
+    uint32_t tls_heap_used;     // mbedTLS heap in use now (bytes)
+    uint32_t tls_heap_peak;     // Most mbedTLS heap ever in use at once
+};
+
+// Make a request on a pooled connection to host:port, opening one if
+// needed. Same arguments and return value as http_client_req(). If a reused
+// connection turns out to be dead before any response arrives, the request
+// is sent once more on a new connection.
+int http_pool_request(const char *host,
+                      const char *port,
+                      struct http_request *req,
+                      int32_t timeout_ms,
+                      void *user_data);
+
+#ifdef CONFIG_HTTP_POOL_TLS
+// Same as http_pool_request(), over HTTPS. TLS connections are pooled
+// separately from plain ones to the same host and port.
+int http_pool_request_tls(const char *host,
+                          const char *port,
+                          struct http_request *req,
+                          int32_t timeout_ms,
+                          void *user_data);
+#endif
+
+// Close every idle connection (e.g. before the network goes down)
+void http_pool_close_all(void);
+
+// Get a snapshot of the pool counters. The heap figures need
+// MBEDTLS_ENABLE_HEAP and MBEDTLS_MEMORY_DEBUG, else they stay 0.
+void http_pool_stats_get(struct http_pool_stats *stats);
+
+#endif /* HTTP_POOL_H_ */
@@ -0,0 +1,590 @@
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/net/socket.h>
+#include <zephyr/posix/fcntl.h>
+
+#include "http_serve.h"
+
+// Enable logging at CONFIG_LOG_DEFAULT_LEVEL
+LOG_MODULE_REGISTER(http_serve);
+
+// Connections waiting to be accepted
+#define LISTEN_BACKLOG 4
+
+// Canned replies (sent from flash like any static body)
+static const char rsp_not_found[] =
+    "HTTP/1.1 404 Not Found\r\n"
+    "Content-Length: 0\r\n"
+    "Connection: keep-alive\r\n\r\n";
+static const char rsp_bad_method[] =
+    "HTTP/1.1 405 Method Not Allowed\r\n"
+    "Allow: GET, HEAD\r\n"
+    "Content-Length: 0\r\n"
+    "Connection: close\r\n\r\n";
+static const char rsp_too_large[] =
+    "HTTP/1.1 431 Request Header Fields Too Large\r\n"
+    "Content-Length: 0\r\n"
+    "Connection: close\r\n\r\n";
+
+// One connected client. A response is sent as up to two pieces straight
+// from the resource (head and body), except for a dynamic one, which goes
+// out from a copy in snap.
+struct client {
+    int sock;
+    uint8_t rx[CONFIG_HTTP_SERVE_RX_BUF_SIZE + 1];
+    size_t rx_len;
+    uint8_t snap[CONFIG_HTTP_SERVE_DYNAMIC_MAX];
+    const uint8_t *tx[2];
+    size_t tx_len[2];
+    int tx_idx;
+    bool close_after;
+    int64_t last_ms;        // Last request received or response data sent
+};
+
+//------------------------------------------------------------------------------
+// Forward declarations
+
+static void client_close(struct client *c);
+static int32_t client_timeout_ms(const struct client *c);
+static bool header_says(const char *hdrs, const char *name, const char *value);
+static void client_respond(struct client *c, const char *req);
+static void client_send(struct client *c);
+static void client_process(struct client *c);
+static void client_recv(struct client *c);
+static void server_accept(void);
+static void http_serve_thread_start(void *arg1, void *arg2, void *arg3);
+
+//------------------------------------------------------------------------------
+// Globals
+
+// Registered resources
+static struct http_serve_resource *resources[CONFIG_HTTP_SERVE_MAX_RESOURCES];
+static int num_resources;
+
+// Held while a dynamic field is written or a response copied out
+static K_MUTEX_DEFINE(fields_lock);
+
+// Server thread and its sockets
+K_THREAD_STACK_DEFINE(http_serve_stack, CONFIG_HTTP_SERVE_THREAD_STACK_SIZE);
+static struct k_thread http_serve_thread;
+static int listen_sock = -1;
+static struct client clients[CONFIG_HTTP_SERVE_MAX_CLIENTS];
+
+// Counters (written by the server thread only)
+static struct http_serve_stats stats;
+
+//------------------------------------------------------------------------------
+// Private functions
+
+static void client_close(struct client *c)
+{
+    zsock_close(c->sock);
+    c->sock = -1;
+    stats.active--;
+}
+
+// How long a client may make no progress: sending a response, or waiting
+// for the next request on a kept-alive connection
+static int32_t client_timeout_ms(const struct client *c)
+{
+    if (c->tx_idx < 2) {
+        return CONFIG_HTTP_SERVE_SEND_TIMEOUT_MS;
+    }
+
+    return CONFIG_HTTP_SERVE_IDLE_TIMEOUT_MS;
+}
+
+// Check the request headers for "name: ...value..." (both case-insensitive)
+static bool header_says(const char *hdrs, const char *name, const char *value)
+{
+    size_t name_len = strlen(name);
+    size_t value_len = strlen(value);
+    const char *line = hdrs;
+    const char *end;
+
+    while ((line = strstr(line, "\r\n")) != NULL) {
+        line += 2;
+        if ((strncasecmp(line, name, name_len) != 0) || (line[name_len] != ':')) {
+            continue;
+        }
+        end = strstr(line, "\r\n");
+        for (const char *p = line + name_len + 1; (p + value_len) <= end; p++) {
+            if (strncasecmp(p, value, value_len) == 0) {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+// Pick the response for one complete request (line and headers, which end
+// in an empty line and are NUL-terminated here)
+static void client_respond(struct client *c, const char *req)
+{
+    struct http_serve_resource *res = NULL;
+    const char *path;
+    size_t path_len;
+    bool head;
+
+    stats.requests++;
+    c->tx_idx = 0;
+    c->tx_len[1] = 0;
+
+    head = (strncmp(req, "HEAD ", 5) == 0);
+    if (!head && (strncmp(req, "GET ", 4) != 0)) {
+        stats.bad_requests++;
+        c->tx[0] = (const uint8_t *)rsp_bad_method;
+        c->tx_len[0] = sizeof(rsp_bad_method) - 1;
+        c->close_after = true;
+        return;
+    }
+
+    // HTTP/1.1 keeps the connection unless told otherwise, 1.0 the reverse
+    if (strstr(req, " HTTP/1.0\r\n") != NULL) {
+        c->close_after = !header_says(req, "Connection", "keep-alive");
+    } else {
+        c->close_after = header_says(req, "Connection", "close");
+    }
+
+    // The path runs to the next space, without any query string
+    path = strchr(req, ' ') + 1;
+    path_len = strcspn(path, " ?");
+    for (int i = 0; i < num_resources; i++) {
+        if ((strlen(resources[i]->path) == path_len) &&
+            (memcmp(resources[i]->path, path, path_len) == 0)) {
+            res = resources[i];
+            break;
+        }
+    }
+
+    if (res == NULL) {
+        stats.not_found++;
+        c->tx[0] = (const uint8_t *)rsp_not_found;
+        c->tx_len[0] = sizeof(rsp_not_found) - 1;
+        return;
+    }
+    res->hits++;
+
+    if (res->body == NULL) {
+        c->tx[0] = c->snap;
+        c->tx_len[0] = head ? res->head_len : res->buf_len;
+        k_mutex_lock(&fields_lock, K_FOREVER);
+        memcpy(c->snap, res->buf, c->tx_len[0]);
+        k_mutex_unlock(&fields_lock);
+    } else {
+        c->tx[0] = (const uint8_t *)res->head;
+        c->tx_len[0] = res->head_len;
+        c->tx[1] = res->body;
+        c->tx_len[1] = head ? 0 : res->body_len;
+    }
+}
+
+// Send as much of the pending response as the socket takes now
+static void client_send(struct client *c)
+{
+    ssize_t ret;
+
+    while (c->tx_idx < 2) {
+        if (c->tx_len[c->tx_idx] == 0) {
+            c->tx_idx++;
+            continue;
+        }
+
+        ret = zsock_send(c->sock, c->tx[c->tx_idx], c->tx_len[c->tx_idx], 0);
+        if (ret < 0) {
+            if ((errno != EAGAIN) && (errno != EWOULDBLOCK)) {
+                client_close(c);
+            }
+            return;
+        }
+        c->tx[c->tx_idx] += ret;
+        c->tx_len[c->tx_idx] -= ret;
+        c->last_ms = k_uptime_get();
+        stats.tx_bytes += ret;
+    }
+
+    if (c->close_after) {
+        client_close(c);
+    }
+}
+
+// Answer every complete request in the buffer, one at a time: the next
+// (pipelined) one waits until the current response has gone out
+static void client_process(struct client *c)
+{
+    uint8_t *end;
+    size_t req_len;
+    uint8_t saved;
+
+    while ((c->sock >= 0) && (c->tx_idx >= 2)) {
+        end = NULL;
+        for (size_t i = 3; i < c->rx_len; i++) {
+            if (memcmp(&c->rx[i - 3], "\r\n\r\n", 4) == 0) {
+                end = &c->rx[i + 1];
+                break;
+            }
+        }
+
+        if (end == NULL) {
+            if (c->rx_len == CONFIG_HTTP_SERVE_RX_BUF_SIZE) {
+                stats.requests++;
+                stats.bad_requests++;
+                c->tx[0] = (const uint8_t *)rsp_too_large;
+                c->tx_len[0] = sizeof(rsp_too_large) - 1;
+                c->tx_len[1] = 0;
+                c->tx_idx = 0;
+                c->close_after = true;
+                client_send(c);
+            }
+            return;
+        }
+
+        // NUL-terminate the headers for the string searches, keeping the
+        // byte this replaces (the start of any pipelined request)
+        req_len = end - c->rx;
+        saved = c->rx[req_len];
+        c->rx[req_len] = '\0';
+        client_respond(c, (const char *)c->rx);
+        c->rx[req_len] = saved;
+
+        memmove(c->rx, end, c->rx_len - req_len);
+        c->rx_len -= req_len;
+        client_send(c);
+    }
+}
+
+// Read what has arrived and answer it
+static void client_recv(struct client *c)
+{
+    ssize_t len;
+
+    len = zsock_recv(c->sock,
+                     c->rx + c->rx_len,
+                     CONFIG_HTTP_SERVE_RX_BUF_SIZE - c->rx_len,
+                     0);
+    if (len <= 0) {
+        if ((len < 0) && ((errno == EAGAIN) || (errno == EWOULDBLOCK))) {
+            return;
+        }
+        client_close(c);
+        return;
+    }
+    c->rx_len += len;
+    c->last_ms = k_uptime_get();
+
+    client_process(c);
+}
+
+// Take a new connection into a free slot
+static void server_accept(void)
+{
+    struct client *c = NULL;
+    int one = 1;
+    int sock;
+
+    sock = zsock_accept(listen_sock, NULL, NULL);
+    if (sock < 0) {
+        return;
+    }
+
+    for (int i = 0; i < CONFIG_HTTP_SERVE_MAX_CLIENTS; i++) {
+        if (clients[i].sock < 0) {
+            c = &clients[i];
+            break;
+        }
+    }
+    if ((c == NULL) || (zsock_fcntl(sock, F_SETFL, O_NONBLOCK) < 0)) {
+        zsock_close(sock);
+        return;
+    }
+
+    // A response goes out as two sends (head, body): without this the
+    // body would wait for the client's delayed ACK of the head
+    zsock_setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+    c->sock = sock;
+    c->rx_len = 0;
+    c->tx_idx = 2;
+    c->close_after = false;
+    c->last_ms = k_uptime_get();
+    stats.accepted++;
+    stats.active++;
+    stats.max_active = MAX(stats.max_active, stats.active);
+}
+
+// Server loop: one poll over the listening socket and every client
+static void http_serve_thread_start(void *arg1, void *arg2, void *arg3)
+{
+    struct zsock_pollfd fds[1 + CONFIG_HTTP_SERVE_MAX_CLIENTS];
+    struct client *polled[1 + CONFIG_HTTP_SERVE_MAX_CLIENTS];
+    int num_fds;
+    int64_t now;
+    int64_t left;
+    int32_t timeout_ms;
+    int ret;
+
+    while (1) {
+
+        // Only accept while there is a free slot, the backlog holds the rest
+        fds[0].fd = listen_sock;
+        fds[0].events = (stats.active < CONFIG_HTTP_SERVE_MAX_CLIENTS) ? ZSOCK_POLLIN : 0;
+        fds[0].revents = 0;
+        num_fds = 1;
+
+        // Sleep no longer than the first client deadline
+        now = k_uptime_get();
+        timeout_ms = SYS_FOREVER_MS;
+        for (int i = 0; i < CONFIG_HTTP_SERVE_MAX_CLIENTS; i++) {
+            struct client *c = &clients[i];
+
+            if (c->sock < 0) {
+                continue;
+            }
+            polled[num_fds] = c;
+            fds[num_fds].fd = c->sock;
+            fds[num_fds].events = (c->tx_idx < 2) ? ZSOCK_POLLOUT : ZSOCK_POLLIN;
+            fds[num_fds].revents = 0;
+            num_fds++;
+
+            left = MAX(c->last_ms + client_timeout_ms(c) - now, 0);
+            if ((timeout_ms < 0) || (left < timeout_ms)) {
+                timeout_ms = (int32_t)left;
+            }
+        }
+
+        stats.polls++;
+        ret = zsock_poll(fds, num_fds, timeout_ms);
+        if (ret < 0) {
+            LOG_ERR("Error (%d): poll failed", -errno);
+            k_msleep(100);
+            continue;
+        }
+
+        for (int i = 1; i < num_fds; i++) {
+            struct client *c = polled[i];
+
+            if (fds[i].revents == 0) {
+                continue;
+            }
+            if (fds[i].revents & (ZSOCK_POLLERR | ZSOCK_POLLNVAL)) {
+                client_close(c);
+            } else if (c->tx_idx < 2) {
+                client_send(c);
+                client_process(c);
+            } else {
+                client_recv(c);
+            }
+        }
+
+        if (fds[0].revents & ZSOCK_POLLIN) {
+            server_accept();
+        }
+
+        // Drop kept-alive connections nobody is using, and clients that
+        // stopped reading their response. Nobody is left past a deadline,
+        // so the next poll cannot return straight away for the same one.
+        now = k_uptime_get();
+        for (int i = 0; i < CONFIG_HTTP_SERVE_MAX_CLIENTS; i++) {
+            struct client *c = &clients[i];
+
+            if ((c->sock < 0) || ((now - c->last_ms) < client_timeout_ms(c))) {
+                continue;
+            }
+            if (c->tx_idx < 2) {
+                stats.send_timeouts++;
+            } else {
+                stats.idle_closed++;
+            }
+            client_close(c);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+// Public functions (API)
+
+// Register a resource served straight from body
+int http_serve_add_static(struct http_serve_resource *res,
+                          const char *path,
+                          const char *content_type,
+                          const void *body,
+                          size_t body_len)
+{
+    int len;
+
+    if (num_resources >= CONFIG_HTTP_SERVE_MAX_RESOURCES) {
+        return -ENOMEM;
+    }
+
+    len = snprintf(res->head,
+                   sizeof(res->head),
+                   "HTTP/1.1 200 OK\r\n"
+                   "Content-Type: %s\r\n"
+                   "Content-Length: %u\r\n"
+                   "Connection: keep-alive\r\n\r\n",
+                   content_type,
+                   (unsigned int)body_len);
+    if ((len < 0) || (len >= (int)sizeof(res->head))) {
+        return -ENOMEM;
+    }
+
+    res->path = path;
+    res->head_len = len;
+    res->body = body;
+    res->body_len = body_len;
+    res->buf = NULL;
+    res->buf_len = 0;
+    res->num_fields = 0;
+    res->hits = 0;
+    resources[num_resources++] = res;
+
+    return 0;
+}
+
+// Register a resource pre-encoded into buf, with in-place fields
+int http_serve_add_dynamic(struct http_serve_resource *res,
+                           const char *path,
+                           const char *content_type,
+                           uint8_t *buf,
+                           size_t buf_size,
+                           const char *body_template)
+{
+    size_t body_len = strlen(body_template);
+    size_t pos;
+    int len;
+
+    if (num_resources >= CONFIG_HTTP_SERVE_MAX_RESOURCES) {
+        return -ENOMEM;
+    }
+
+    len = snprintf((char *)buf,
+                   buf_size,
+                   "HTTP/1.1 200 OK\r\n"
+                   "Content-Type: %s\r\n"
+                   "Content-Length: %u\r\n"
+                   "Cache-Control: no-store\r\n"
+                   "Connection: keep-alive\r\n\r\n",
+                   content_type,
+                   (unsigned int)body_len);
+    if ((len < 0) || ((size_t)len + body_len > MIN(buf_size, CONFIG_HTTP_SERVE_DYNAMIC_MAX))) {
+        return -ENOMEM;
+    }
+    memcpy(buf + len, body_template, body_len);
+
+    res->path = path;
+    res->head_len = len;
+    res->body = NULL;
+    res->body_len = body_len;
+    res->buf = buf;
+    res->buf_len = len + body_len;
+    res->num_fields = 0;
+    res->hits = 0;
+
+    // Each run of '#' is a field, starting out as 0
+    for (pos = len; pos < res->buf_len; pos++) {
+        size_t width = 0;
+
+        while ((pos + width < res->buf_len) && (buf[pos + width] == '#')) {
+            width++;
+        }
+        if (width == 0) {
+            continue;
+        }
+        if ((res->num_fields >= CONFIG_HTTP_SERVE_MAX_FIELDS) || (width > UINT8_MAX)) {
+            return -ENOMEM;
+        }
+        res->field_off[res->num_fields] = pos;
+        res->field_width[res->num_fields] = width;
+        http_serve_set_int(res, res->num_fields++, 0);
+        pos += width;
+    }
+
+    resources[num_resources++] = res;
+
+    return 0;
+}
+
+// Overwrite a field with a right-aligned number
+int http_serve_set_int(struct http_serve_resource *res, int field, int32_t value)
+{
+    char digits[12];
+    uint8_t width;
+    int len;
+
+    if ((field < 0) || (field >= res->num_fields)) {
+        return -EINVAL;
+    }
+    width = res->field_width[field];
+
+    len = snprintf(digits, sizeof(digits), "%d", value);
+    if (len > width) {
+        return -ERANGE;
+    }
+
+    k_mutex_lock(&fields_lock, K_FOREVER);
+    memcpy(res->buf + res->field_off[field] + width - len, digits, len);
+    memset(res->buf + res->field_off[field], ' ', width - len);
+    k_mutex_unlock(&fields_lock);
+
+    return 0;
+}
+
+// Open the listening socket and start the server thread
+int http_serve_start(void)
+{
+    struct sockaddr_in addr;
+    int opt = 1;
+    int ret;
+
+    for (int i = 0; i < CONFIG_HTTP_SERVE_MAX_CLIENTS; i++) {
+        clients[i].sock = -1;
+    }
+
+    listen_sock = zsock_socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (listen_sock < 0) {
+        ret = -errno;
+        LOG_ERR("Error (%d): could not create socket", ret);
+        return ret;
+    }
+    zsock_setsockopt(listen_sock, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(CONFIG_HTTP_SERVE_PORT);
+
+    if ((zsock_bind(listen_sock, (struct sockaddr *)&addr, sizeof(addr)) < 0) ||
+        (zsock_listen(listen_sock, LISTEN_BACKLOG) < 0) ||
+        (zsock_fcntl(listen_sock, F_SETFL, O_NONBLOCK) < 0)) {
+        ret = -errno;
+        LOG_ERR("Error (%d): could not listen on port %d", ret, CONFIG_HTTP_SERVE_PORT);
+        zsock_close(listen_sock);
+        listen_sock = -1;
+        return ret;
+    }
+
+    k_thread_create(&http_serve_thread,
+                    http_serve_stack,
+                    K_THREAD_STACK_SIZEOF(http_serve_stack),
+                    http_serve_thread_start,
+                    NULL,
+                    NULL,
+                    NULL,
+                    CONFIG_HTTP_SERVE_THREAD_PRIORITY,
+                    0,
+                    K_NO_WAIT);
+    k_thread_name_set(&http_serve_thread, "http_serve");
+
+    return 0;
+}
+
+// Get a snapshot of the counters
+void http_serve_stats_get(struct http_serve_stats *stats_out)
+{
+    *stats_out = stats;
+}
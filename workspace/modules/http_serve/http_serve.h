@@ -0,0 +1,79 @@
+#ifndef HTTP_SERVE_H_
+#define HTTP_SERVE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Longest status line and headers of a static resource
+#define HTTP_SERVE_HEAD_MAX 128
+
+// One resource. Fill it in with http_serve_add_static() or
+// http_serve_add_dynamic(); it must stay valid while the server runs.
+struct http_serve_resource {
+    const char *path;
+
+    // What is sent: head then body for a static resource (the body is not
+    // copied), or the whole response from the caller's buffer for a
+    // dynamic one (body is NULL)
+    char head[HTTP_SERVE_HEAD_MAX];
+    size_t head_len;
+    const uint8_t *body;
+    size_t body_len;
+    uint8_t *buf;
+    size_t buf_len;
+
+    // In-place fields of a dynamic resource (offset into buf, width)
+    uint16_t field_off[CONFIG_HTTP_SERVE_MAX_FIELDS];
+    uint8_t field_width[CONFIG_HTTP_SERVE_MAX_FIELDS];
+    uint8_t num_fields;
+
+    uint32_t hits;
+};
+
+// Server counters
+struct http_serve_stats {
+    uint32_t accepted;      // Connections accepted
+    uint32_t requests;      // Requests answered (any status)
+    uint32_t not_found;
+    uint32_t bad_requests;  // Unsupported method or oversized headers
+    uint32_t idle_closed;   // Kept-alive connections closed for being idle
+    uint32_t send_timeouts; // Clients closed for not reading a response
+    uint32_t active;        // Clients connected now
+    uint32_t max_active;
+    uint32_t polls;         // zsock_poll() calls
+    uint32_t tx_bytes;
+};
+
+// Register a resource whose body never changes. body is sent as is (no
+// copy), so it can be a const array in flash.
+int http_serve_add_static(struct http_serve_resource *res,
+                          const char *path,
+                          const char *content_type,
+                          const void *body,
+                          size_t body_len);
+
+// Register a resource whose response is built once, into buf, from
+// body_template. Each run of '#' in the template becomes a field that
+// http_serve_set_int() overwrites in place. Each request gets a copy of
+// the response taken under the same lock as the updates, so a field is
+// always sent whole with its old or new value. Separate fields are not
+// updated together. The response must fit in CONFIG_HTTP_SERVE_DYNAMIC_MAX.
+int http_serve_add_dynamic(struct http_serve_resource *res,
+                           const char *path,
+                           const char *content_type,
+                           uint8_t *buf,
+                           size_t buf_size,
+                           const char *body_template);
+
+// Write value right-aligned (space padded) into a field. Returns -ERANGE
+// if it does not fit, leaving the field as it was. Safe to call from any
+// thread while the server runs.
+int http_serve_set_int(struct http_serve_resource *res, int field, int32_t value);
+
+// Start listening on CONFIG_HTTP_SERVE_PORT (add the resources first)
+int http_serve_start(void);
+
+// Get a snapshot of the counters
+void http_serve_stats_get(struct http_serve_stats *stats);
+
+#endif /* HTTP_SERVE_H_ */
@@ -0,0 +1,289 @@
+#include <errno.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/crc.h>
+
+#include "http_stream.h"
+
+// The client's own response callback only sees body_frag, which runs from
+// the first body byte to the end of the read: with chunked encoding that
+// includes the chunk size lines between chunks. The parser callbacks get
+// each de-chunked piece, so the sinks are fed from those instead.
+
+//------------------------------------------------------------------------------
+// Forward declarations
+
+static struct http_stream *stream_get(struct http_parser *parser);
+static void stream_write(struct http_stream *stream,
+                         enum http_span span,
+                         const char *at,
+                         size_t len);
+static int on_header_field(struct http_parser *parser, const char *at, size_t len);
+static int on_header_value(struct http_parser *parser, const char *at, size_t len);
+static int on_headers_complete(struct http_parser *parser);
+static int on_body(struct http_parser *parser, const char *at, size_t len);
+static int on_message_complete(struct http_parser *parser);
+static void response_cb(struct http_response *rsp,
+                        enum http_final_call final_data,
+                        void *user_data);
+static int print_start(struct http_sink *sink, uint16_t status);
+static int print_write(struct http_sink *sink,
+                       enum http_span span,
+                       const uint8_t *data,
+                       size_t len);
+static void print_end(struct http_sink *sink, int result);
+static int crc32_write(struct http_sink *sink,
+                       enum http_span span,
+                       const uint8_t *data,
+                       size_t len);
+
+//------------------------------------------------------------------------------
+// Globals
+
+// Parser hooks shared by every stream (the stream is found via the request)
+static const struct http_parser_settings stream_settings = {
+    .on_header_field = on_header_field,
+    .on_header_value = on_header_value,
+    .on_headers_complete = on_headers_complete,
+    .on_body = on_body,
+    .on_message_complete = on_message_complete,
+};
+
+static const struct http_sink_api print_api = {
+    .start = print_start,
+    .write = print_write,
+    .end = print_end,
+};
+
+static const struct http_sink_api crc32_api = {
+    .write = crc32_write,
+};
+
+//------------------------------------------------------------------------------
+// Private functions
+
+// The stream is the user_data given to http_client_req()
+static struct http_stream *stream_get(struct http_parser *parser)
+{
+    struct http_request *req = CONTAINER_OF(parser, struct http_request, internal.parser);
+
+    return req->internal.user_data;
+}
+
+// Hand a span to every sink that has not failed
+static void stream_write(struct http_stream *stream,
+                         enum http_span span,
+                         const char *at,
+                         size_t len)
+{
+    int ret;
+
+    for (struct http_sink *s = stream->sinks; s != NULL; s = s->next) {
+        if ((s->err == 0) && (s->api->write != NULL)) {
+            ret = s->api->write(s, span, (const uint8_t *)at, len);
+            if (ret < 0) {
+                s->err = ret;
+            }
+        }
+    }
+}
+
+static int on_header_field(struct http_parser *parser, const char *at, size_t len)
+{
+    stream_write(stream_get(parser), HTTP_SPAN_HEADER_NAME, at, len);
+
+    return 0;
+}
+
+static int on_header_value(struct http_parser *parser, const char *at, size_t len)
+{
+    stream_write(stream_get(parser), HTTP_SPAN_HEADER_VALUE, at, len);
+
+    return 0;
+}
+
+// Status line and headers are in: tell the sinks a body may follow
+static int on_headers_complete(struct http_parser *parser)
+{
+    struct http_stream *stream = stream_get(parser);
+    int ret;
+
+    stream->status = parser->status_code;
+    for (struct http_sink *s = stream->sinks; s != NULL; s = s->next) {
+        if ((s->err == 0) && (s->api->start != NULL)) {
+            ret = s->api->start(s, stream->status);
+            if (ret < 0) {
+                s->err = ret;
+            }
+        }
+    }
+
+    return 0;
+}
+
+static int on_body(struct http_parser *parser, const char *at, size_t len)
+{
+    struct http_stream *stream = stream_get(parser);
+
+    stream->body_len += len;
+    stream_write(stream, HTTP_SPAN_BODY, at, len);
+
+    return 0;
+}
+
+static int on_message_complete(struct http_parser *parser)
+{
+    stream_get(parser)->complete = true;
+
+    return 0;
+}
+
+// Everything was delivered by the parser hooks already
+static void response_cb(struct http_response *rsp,
+                        enum http_final_call final_data,
+                        void *user_data)
+{
+    ARG_UNUSED(rsp);
+    ARG_UNUSED(final_data);
+    ARG_UNUSED(user_data);
+}
+
+// Print sink: headers as "name: value" lines, then the body as is
+static int print_start(struct http_sink *sink, uint16_t status)
+{
+    struct http_sink_print *p = CONTAINER_OF(sink, struct http_sink_print, sink);
+
+    if (p->last == HTTP_SPAN_HEADER_VALUE) {
+        printk("\r\n");
+    }
+    printk("Status: %u\r\n", status);
+    p->last = HTTP_SPAN_BODY;
+
+    return 0;
+}
+
+static int print_write(struct http_sink *sink,
+                       enum http_span span,
+                       const uint8_t *data,
+                       size_t len)
+{
+    struct http_sink_print *p = CONTAINER_OF(sink, struct http_sink_print, sink);
+
+    // Separators go in when the span type changes, pieces are printed as is
+    if ((span == HTTP_SPAN_HEADER_NAME) && (p->last == HTTP_SPAN_HEADER_VALUE)) {
+        printk("\r\n");
+    } else if ((span == HTTP_SPAN_HEADER_VALUE) && (p->last == HTTP_SPAN_HEADER_NAME)) {
+        printk(": ");
+    }
+    p->last = span;
+
+    if ((span != HTTP_SPAN_BODY) || p->body) {
+        printk("%.*s", (int)len, (const char *)data);
+    }
+
+    return 0;
+}
+
+static void print_end(struct http_sink *sink, int result)
+{
+    struct http_sink_print *p = CONTAINER_OF(sink, struct http_sink_print, sink);
+
+    if (p->body) {
+        printk("\r\n");
+    }
+    if (result < 0) {
+        printk("Response failed (%d)\r\n", result);
+    }
+}
+
+// CRC sink: checksum of the body only
+static int crc32_write(struct http_sink *sink,
+                       enum http_span span,
+                       const uint8_t *data,
+                       size_t len)
+{
+    struct http_sink_crc32 *c = CONTAINER_OF(sink, struct http_sink_crc32, sink);
+
+    if (span == HTTP_SPAN_BODY) {
+        c->crc = crc32_ieee_update(c->crc, data, len);
+        c->len += len;
+    }
+
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+// Public functions (API)
+
+// Set up a stream with no sinks
+void http_stream_init(struct http_stream *stream)
+{
+    stream->sinks = NULL;
+    stream->status = 0;
+    stream->body_len = 0;
+    stream->complete = false;
+}
+
+// Add a sink at the end of the list
+void http_stream_add(struct http_stream *stream, struct http_sink *sink)
+{
+    struct http_sink **pos = &stream->sinks;
+
+    while (*pos != NULL) {
+        pos = &(*pos)->next;
+    }
+    sink->next = NULL;
+    sink->err = 0;
+    *pos = sink;
+}
+
+// Route a request's response to the stream, clearing what is left from the
+// last response (sinks keep their own state)
+void http_stream_attach(struct http_stream *stream, struct http_request *req)
+{
+    stream->status = 0;
+    stream->body_len = 0;
+    stream->complete = false;
+    for (struct http_sink *s = stream->sinks; s != NULL; s = s->next) {
+        s->err = 0;
+    }
+
+    req->http_cb = &stream_settings;
+    req->response = response_cb;
+}
+
+// Finish the response and tell every sink how it went
+int http_stream_end(struct http_stream *stream, int ret)
+{
+    int result = (ret < 0) ? ret : 0;
+
+    if ((result == 0) && !stream->complete) {
+        result = -EPIPE;
+    }
+    for (struct http_sink *s = stream->sinks; (result == 0) && (s != NULL); s = s->next) {
+        result = s->err;
+    }
+
+    for (struct http_sink *s = stream->sinks; s != NULL; s = s->next) {
+        if (s->api->end != NULL) {
+            s->api->end(s, result);
+        }
+    }
+
+    return result;
+}
+
+// Set up a print sink (body printed too if body is set)
+void http_sink_print_init(struct http_sink_print *p, bool body)
+{
+    p->sink.api = &print_api;
+    p->body = body;
+    p->last = HTTP_SPAN_BODY;
+}
+
+// Set up a CRC-32 sink
+void http_sink_crc32_init(struct http_sink_crc32 *c)
+{
+    c->sink.api = &crc32_api;
+    c->crc = 0;
+    c->len = 0;
+}
@@ -0,0 +1,77 @@
+#ifndef HTTP_STREAM_H_
+#define HTTP_STREAM_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <zephyr/net/http/client.h>
+
+// What a span of the receive buffer holds. Names and values can arrive in
+// more than one piece if they straddle two reads.
+enum http_span {
+    HTTP_SPAN_HEADER_NAME,
+    HTTP_SPAN_HEADER_VALUE,
+    HTTP_SPAN_BODY,         // De-chunked body data
+};
+
+struct http_sink;
+
+// Sink callbacks (any can be NULL). Spans point into the receive buffer and
+// are only valid during the call. A negative return stops further calls to
+// that sink and is reported by http_stream_end().
+struct http_sink_api {
+    int (*start)(struct http_sink *sink, uint16_t status);
+    int (*write)(struct http_sink *sink, enum http_span span, const uint8_t *data, size_t len);
+    void (*end)(struct http_sink *sink, int result);
+};
+
+// One consumer of a response. Embed it in a larger struct for sink state.
+struct http_sink {
+    const struct http_sink_api *api;
+    struct http_sink *next;
+    int err;
+};
+
+// A response being streamed to a list of sinks
+struct http_stream {
+    struct http_sink *sinks;
+    uint16_t status;
+    size_t body_len;
+    bool complete;
+};
+
+// Prints status, headers and (optionally) the body as text
+struct http_sink_print {
+    struct http_sink sink;
+    bool body;
+    enum http_span last;
+};
+
+// Running CRC-32 (IEEE) and length of the body
+struct http_sink_crc32 {
+    struct http_sink sink;
+    uint32_t crc;
+    size_t len;
+};
+
+// Set up a stream with no sinks
+void http_stream_init(struct http_stream *stream);
+
+// Add a sink (called in the order they were added)
+void http_stream_add(struct http_stream *stream, struct http_sink *sink);
+
+// Route a request's response to the stream (call before every request).
+// The stream must then be passed as the user_data of http_client_req() or
+// http_pool_request().
+void http_stream_attach(struct http_stream *stream, struct http_request *req);
+
+// Finish the response with the request's return value. Every sink's end()
+// gets the result, which is ret if it failed, -EPIPE if the response was
+// cut short, else the first sink error (or 0).
+int http_stream_end(struct http_stream *stream, int ret);
+
+// Set up the built-in sinks
+void http_sink_print_init(struct http_sink_print *p, bool body);
+void http_sink_crc32_init(struct http_sink_crc32 *c);
+
+#endif /* HTTP_STREAM_H_ */
@@ -0,0 +1,429 @@
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/sys_heap.h>
+#include <lvgl.h>
+
+#include "lvgl_arena.h"
+
+// Enable logging at CONFIG_LOG_DEFAULT_LEVEL
+LOG_MODULE_REGISTER(lvgl_arena);
+
+// One size class: a fixed array of equal blocks with a free list threaded
+// through the unused ones. Freeing finds the class from the address, so
+// blocks carry no header.
+struct slab {
+    uint8_t *mem;
+    uint16_t *requested;    // Size asked for, per block (for fragmentation)
+    uint16_t size;
+    uint16_t blocks;
+    void *free_list;
+    uint16_t used;
+    uint16_t peak;
+    uint32_t spills;
+};
+
+//------------------------------------------------------------------------------
+// Forward declarations
+
+static struct slab *slab_find(const void *ptr);
+static void *slab_alloc(struct slab *slab, size_t size);
+static void slab_free(struct slab *slab, void *ptr);
+static void *arena_alloc(size_t size);
+static void arena_free(void *ptr);
+
+//------------------------------------------------------------------------------
+// Globals
+
+// Slab storage (blocks are multiples of 8 bytes, so all stay 8-byte aligned)
+#define SLAB_DEFINE(sz)                                                       \
+    static uint8_t slab_mem_##sz[sz * CONFIG_LVGL_ARENA_SLAB_##sz] __aligned(8); \
+    static uint16_t slab_req_##sz[CONFIG_LVGL_ARENA_SLAB_##sz]
+
+SLAB_DEFINE(16);
+SLAB_DEFINE(32);
+SLAB_DEFINE(64);
+SLAB_DEFINE(128);
+SLAB_DEFINE(256);
+
+#define SLAB_INIT(sz)                                                         \
+    { .mem = slab_mem_##sz, .requested = slab_req_##sz,                       \
+      .size = sz, .blocks = CONFIG_LVGL_ARENA_SLAB_##sz }
+
+// Size classes, smallest first
+static struct slab slabs[LVGL_ARENA_NUM_CLASSES] = {
+    SLAB_INIT(16),
+    SLAB_INIT(32),
+    SLAB_INIT(64),
+    SLAB_INIT(128),
+    SLAB_INIT(256),
+};
+
+// Heap for large blocks and slab overflow
+static uint8_t heap_mem[CONFIG_LVGL_ARENA_HEAP_SIZE] __aligned(8);
+static struct sys_heap heap;
+
+// Counters (protected by the lock along with the slabs and heap)
+static struct k_spinlock lock;
+static uint32_t num_allocs;
+static uint32_t num_frees;
+static uint32_t num_failures;
+static uint32_t slab_used_bytes;
+static uint32_t slab_requested_bytes;
+static uint32_t slab_peak_bytes;
+
+//------------------------------------------------------------------------------
+// Private functions
+
+// Find the slab a block belongs to, NULL if it came from the heap
+static struct slab *slab_find(const void *ptr)
+{
+    const uint8_t *p = ptr;
+
+    for (int i = 0; i < LVGL_ARENA_NUM_CLASSES; i++) {
+        if ((p >= slabs[i].mem) &&
+            (p < slabs[i].mem + (size_t)slabs[i].size * slabs[i].blocks)) {
+            return &slabs[i];
+        }
+    }
+
+    return NULL;
+}
+
+// Pop a block off a slab's free list
+static void *slab_alloc(struct slab *slab, size_t size)
+{
+    void *ptr = slab->free_list;
+
+    if (ptr == NULL) {
+        return NULL;
+    }
+    slab->free_list = *(void **)ptr;
+
+    slab->requested[((uint8_t *)ptr - slab->mem) / slab->size] = (uint16_t)size;
+    slab_used_bytes += slab->size;
+    slab_requested_bytes += size;
+    if (slab_used_bytes > slab_peak_bytes) {
+        slab_peak_bytes = slab_used_bytes;
+    }
+    slab->used++;
+    if (slab->used > slab->peak) {
+        slab->peak = slab->used;
+    }
+
+    return ptr;
+}
+
+// Push a block back onto its slab's free list
+static void slab_free(struct slab *slab, void *ptr)
+{
+    slab_used_bytes -= slab->size;
+    slab_requested_bytes -= slab->requested[((uint8_t *)ptr - slab->mem) / slab->size];
+    slab->used--;
+
+    *(void **)ptr = slab->free_list;
+    slab->free_list = ptr;
+}
+
+// Take the smallest free block that fits: its own class, then larger
+// classes, then the heap. Call with the lock held.
+static void *arena_alloc(size_t size)
+{
+    void *ptr = NULL;
+    int first = -1;
+
+    for (int i = 0; i < LVGL_ARENA_NUM_CLASSES; i++) {
+        if (size > slabs[i].size) {
+            continue;
+        }
+        if (first < 0) {
+            first = i;
+        }
+        ptr = slab_alloc(&slabs[i], size);
+        if (ptr != NULL) {
+            break;
+        }
+    }
+
+    // Count the overflow against the class that should have served it
+    if ((first >= 0) && ((ptr == NULL) || (slab_find(ptr) != &slabs[first]))) {
+        slabs[first].spills++;
+    }
+
+    if (ptr == NULL) {
+        ptr = sys_heap_alloc(&heap, size);
+    }
+
+    if (ptr != NULL) {
+        num_allocs++;
+    } else {
+        num_failures++;
+    }
+
+    return ptr;
+}
+
+// Return a block to its slab or the heap. Call with the lock held.
+static void arena_free(void *ptr)
+{
+    struct slab *slab = slab_find(ptr);
+
+    if (slab != NULL) {
+        slab_free(slab, ptr);
+    } else {
+        sys_heap_free(&heap, ptr);
+    }
+    num_frees++;
+}
+
+//------------------------------------------------------------------------------
+// LVGL memory hooks
+//
+// Zephyr's lv_conf.h maps lv_malloc_core() and friends to lvgl_malloc() etc.
+// in its own lvgl_mem.c, so the arena cannot simply define them. Instead the
+// linker redirects every call to the __wrap_ versions below (see
+// CMakeLists.txt). The lv_mem_*() hooks are wrapped the same way, so it does
+// not matter whether Zephyr or LVGL also provides them.
+
+// Build the free lists (called in place of Zephyr's heap init, before
+// lv_init())
+void __wrap_lvgl_heap_init(void)
+{
+    k_spinlock_key_t key = k_spin_lock(&lock);
+
+    for (int i = 0; i < LVGL_ARENA_NUM_CLASSES; i++) {
+        struct slab *slab = &slabs[i];
+
+        slab->free_list = NULL;
+        for (int b = slab->blocks - 1; b >= 0; b--) {
+            void *block = slab->mem + (size_t)b * slab->size;
+
+            *(void **)block = slab->free_list;
+            slab->free_list = block;
+        }
+        slab->used = 0;
+        slab->peak = 0;
+        slab->spills = 0;
+    }
+    sys_heap_init(&heap, heap_mem, sizeof(heap_mem));
+
+    num_allocs = 0;
+    num_frees = 0;
+    num_failures = 0;
+    slab_used_bytes = 0;
+    slab_requested_bytes = 0;
+    slab_peak_bytes = 0;
+
+    k_spin_unlock(&lock, key);
+}
+
+void __wrap_lv_mem_init(void)
+{
+    // Already set up by __wrap_lvgl_heap_init()
+}
+
+void __wrap_lv_mem_deinit(void)
+{
+    // Nothing to release: the arena is static
+}
+
+// The arena has a fixed layout, extra pools are not supported
+lv_mem_pool_t __wrap_lv_mem_add_pool(void *mem, size_t bytes)
+{
+    LOG_WRN("Extra LVGL memory pools are not supported");
+
+    return NULL;
+}
+
+void __wrap_lv_mem_remove_pool(lv_mem_pool_t pool)
+{
+}
+
+void *__wrap_lvgl_malloc(size_t size)
+{
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    void *ptr = arena_alloc(size);
+
+    k_spin_unlock(&lock, key);
+
+    return ptr;
+}
+
+// Stay in place while the new size still fits the block, which keeps
+// repeated lv_label_set_text() calls on a short label allocation-free
+void *__wrap_lvgl_realloc(void *ptr, size_t new_size)
+{
+    k_spinlock_key_t key;
+    struct slab *slab;
+    size_t old_size;
+    void *new_ptr;
+
+    if (ptr == NULL) {
+        return __wrap_lvgl_malloc(new_size);
+    }
+
+    key = k_spin_lock(&lock);
+
+    slab = slab_find(ptr);
+    if (slab != NULL) {
+        uint16_t *req = &slab->requested[((uint8_t *)ptr - slab->mem) / slab->size];
+
+        if (new_size <= slab->size) {
+            slab_requested_bytes = slab_requested_bytes - *req + new_size;
+            *req = (uint16_t)new_size;
+            k_spin_unlock(&lock, key);
+            return ptr;
+        }
+        old_size = *req;
+    } else {
+        old_size = sys_heap_usable_size(&heap, ptr);
+        if (new_size <= old_size) {
+            k_spin_unlock(&lock, key);
+            return ptr;
+        }
+    }
+
+    // Move to a larger block
+    new_ptr = arena_alloc(new_size);
+    if (new_ptr != NULL) {
+        memcpy(new_ptr, ptr, MIN(old_size, new_size));
+        arena_free(ptr);
+    }
+
+    k_spin_unlock(&lock, key);
+
+    return new_ptr;
+}
+
+void __wrap_lvgl_free(void *ptr)
+{
+    k_spinlock_key_t key;
+
+    if (ptr == NULL) {
+        return;
+    }
+
+    key = k_spin_lock(&lock);
+    arena_free(ptr);
+    k_spin_unlock(&lock, key);
+}
+
+// Fill LVGL's monitor from the arena: fragmentation is the share of the used
+// slab bytes that were not asked for (internal waste of the size classes)
+void __wrap_lv_mem_monitor_core(lv_mem_monitor_t *mon_p)
+{
+    struct lvgl_arena_stats stats;
+    uint32_t total = 0;
+    uint32_t used;
+    uint32_t biggest = 0;
+
+    lvgl_arena_stats_get(&stats);
+
+    for (int i = 0; i < LVGL_ARENA_NUM_CLASSES; i++) {
+        total += stats.classes[i].size * stats.classes[i].blocks;
+        if (stats.classes[i].used < stats.classes[i].blocks) {
+            biggest = stats.classes[i].size;
+        }
+    }
+    total += stats.heap_size;
+    used = stats.slab_used + stats.heap_used;
+
+    memset(mon_p, 0, sizeof(*mon_p));
+    mon_p->total_size = total;
+    mon_p->free_size = total - used;
+    mon_p->free_biggest_size = MAX(biggest, stats.heap_size - stats.heap_used);
+    mon_p->used_cnt = stats.allocs - stats.frees;
+    mon_p->max_used = stats.slab_peak + stats.heap_peak;
+    mon_p->used_pct = (total > 0) ? (uint8_t)(used * 100 / total) : 0;
+    mon_p->frag_pct = (stats.slab_used > 0) ?
+        (uint8_t)((stats.slab_used - stats.slab_requested) * 100 / stats.slab_used) : 0;
+}
+
+// Walk every free list and check it stays inside its slab
+lv_result_t __wrap_lv_mem_test_core(void)
+{
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    lv_result_t res = LV_RESULT_OK;
+
+    for (int i = 0; (i < LVGL_ARENA_NUM_CLASSES) && (res == LV_RESULT_OK); i++) {
+        uint32_t free_blocks = 0;
+
+        for (void *b = slabs[i].free_list; b != NULL; b = *(void **)b) {
+            if ((slab_find(b) != &slabs[i]) || (++free_blocks > slabs[i].blocks)) {
+                res = LV_RESULT_INVALID;
+                break;
+            }
+        }
+        if (free_blocks + slabs[i].used != slabs[i].blocks) {
+            res = LV_RESULT_INVALID;
+        }
+    }
+
+    k_spin_unlock(&lock, key);
+
+    return res;
+}
+
+//------------------------------------------------------------------------------
+// Public functions (API)
+
+// Get a snapshot of the arena usage
+void lvgl_arena_stats_get(struct lvgl_arena_stats *stats)
+{
+    struct sys_memory_stats heap_stats;
+    k_spinlock_key_t key = k_spin_lock(&lock);
+
+    for (int i = 0; i < LVGL_ARENA_NUM_CLASSES; i++) {
+        stats->classes[i].size = slabs[i].size;
+        stats->classes[i].blocks = slabs[i].blocks;
+        stats->classes[i].used = slabs[i].used;
+        stats->classes[i].peak = slabs[i].peak;
+        stats->classes[i].spills = slabs[i].spills;
+    }
+    stats->allocs = num_allocs;
+    stats->frees = num_frees;
+    stats->failures = num_failures;
+    stats->slab_used = slab_used_bytes;
+    stats->slab_requested = slab_requested_bytes;
+    stats->slab_peak = slab_peak_bytes;
+
+    sys_heap_runtime_stats_get(&heap, &heap_stats);
+    stats->heap_size = sizeof(heap_mem);
+    stats->heap_used = heap_stats.allocated_bytes;
+    stats->heap_peak = heap_stats.max_allocated_bytes;
+
+    k_spin_unlock(&lock, key);
+}
+
+// Print the arena usage (per-class table, peak and fragmentation)
+void lvgl_arena_stats_print(void)
+{
+    struct lvgl_arena_stats stats;
+
+    lvgl_arena_stats_get(&stats);
+
+    printk("LVGL arena: %u allocs, %u frees, %u failed\r\n",
+           stats.allocs,
+           stats.frees,
+           stats.failures);
+    for (int i = 0; i < LVGL_ARENA_NUM_CLASSES; i++) {
+        printk("  %3u B: %3u/%3u used, peak %3u, spills %u\r\n",
+               stats.classes[i].size,
+               stats.classes[i].used,
+               stats.classes[i].blocks,
+               stats.classes[i].peak,
+               stats.classes[i].spills);
+    }
+    printk("  slabs: %u B used, peak %u B\r\n",
+           stats.slab_used,
+           stats.slab_peak);
+    printk("  heap: %u/%u B used, peak %u B\r\n",
+           stats.heap_used,
+           stats.heap_size,
+           stats.heap_peak);
+    printk("  slab waste: %u of %u B (%u%%)\r\n",
+           stats.slab_used - stats.slab_requested,
+           stats.slab_used,
+           (stats.slab_used > 0) ?
+               (stats.slab_used - stats.slab_requested) * 100 / stats.slab_used : 0);
+}
@@ -0,0 +1,38 @@
+#ifndef LVGL_ARENA_H_
+#define LVGL_ARENA_H_
+
+#include <stdint.h>
+
+// Number of slab size classes (16, 32, 64, 128 and 256 bytes)
+#define LVGL_ARENA_NUM_CLASSES 5
+
+// Usage of one size class
+struct lvgl_arena_class_stats {
+    uint16_t size;          // Block size (bytes)
+    uint16_t blocks;        // Blocks in the slab
+    uint16_t used;          // Blocks in use
+    uint16_t peak;          // Most blocks ever in use
+    uint32_t spills;        // Requests sent to a larger class or the heap
+};
+
+// Arena usage
+struct lvgl_arena_stats {
+    struct lvgl_arena_class_stats classes[LVGL_ARENA_NUM_CLASSES];
+    uint32_t allocs;        // Successful allocations (realloc counts when it moves)
+    uint32_t frees;
+    uint32_t failures;      // Requests that could not be served
+    uint32_t slab_used;     // Bytes of slab blocks in use
+    uint32_t slab_requested;// Bytes actually asked for in those blocks
+    uint32_t slab_peak;     // Most slab bytes ever in use
+    uint32_t heap_size;
+    uint32_t heap_used;
+    uint32_t heap_peak;
+};
+
+// Get a snapshot of the arena usage
+void lvgl_arena_stats_get(struct lvgl_arena_stats *stats);
+
+// Print the arena usage (per-class table, peak and fragmentation)
+void lvgl_arena_stats_print(void);
+
+#endif /* LVGL_ARENA_H_ */
@@ -0,0 +1,633 @@
+#include <errno.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/drivers/display.h>
+#include <zephyr/logging/log.h>
+#ifdef CONFIG_LVGL_PORT_INPUT
+#include <zephyr/input/input.h>
+#endif
+#include <lvgl.h>
+#ifdef CONFIG_LV_Z_MEM_POOL_SYS_HEAP
+#include <lvgl_mem.h>
+#endif
+
+#include "lvgl_port.h"
+
+// Enable logging at CONFIG_LOG_DEFAULT_LEVEL
+LOG_MODULE_REGISTER(lvgl_port);
+
+// Panel size comes from the chosen display node
+#define DISPLAY_NODE DT_CHOSEN(zephyr_display)
+#define DISPLAY_WIDTH DT_PROP(DISPLAY_NODE, width)
+#define DISPLAY_HEIGHT DT_PROP(DISPLAY_NODE, height)
+
+// Partial render buffer: full width, a few rows, 16 bits per pixel
+#define BUF_ROWS MIN(CONFIG_LVGL_PORT_BUF_ROWS, DISPLAY_HEIGHT)
+#define BUF_SIZE (DISPLAY_WIDTH * BUF_ROWS * 2)
+
+#ifdef CONFIG_LVGL_PORT_INPUT
+
+// Key event from the input subsystem, stamped when it was reported
+struct key_event {
+    uint32_t key;
+    uint32_t stamp;
+    uint8_t pressed;
+};
+#endif
+
+//------------------------------------------------------------------------------
+// Forward declarations
+
+static void panel_write(const lv_area_t *area, uint8_t *px_map);
+static void frame_flushed(uint32_t seq);
+static void flush_cb(lv_display_t *disp, const lv_area_t *area, uint8_t *px_map);
+#ifdef CONFIG_LVGL_PORT_DOUBLE_BUFFER
+static void flush_wait_cb(lv_display_t *disp);
+static void flush_thread_start(void *arg1, void *arg2, void *arg3);
+#endif
+static void stat_update(uint32_t us, uint32_t *last, uint32_t *max, uint64_t *total);
+static void refresh(void);
+static void invalidate_cb(lv_event_t *e);
+#ifdef CONFIG_LVGL_PORT_INPUT
+static uint32_t key_map(uint16_t code);
+static void input_cb(struct input_event *evt, void *user_data);
+static void keypad_read_cb(lv_indev_t *indev, lv_indev_data_t *data);
+#endif
+static void input_process(void);
+
+//------------------------------------------------------------------------------
+// Globals
+
+static const struct device *display_dev = DEVICE_DT_GET(DISPLAY_NODE);
+static lv_display_t *display;
+static uint8_t render_buf[BUF_SIZE] __aligned(LV_DRAW_BUF_ALIGN);
+
+// Written by the flush callback, which runs inside lv_timer_handler()
+static struct lvgl_port_stats stats;
+static uint32_t frame_areas;
+static uint32_t frame_pixels;
+static uint32_t frame_blocked_cyc;      // Render thread waiting on the panel
+static atomic_t flush_cyc;              // Spent in display_write()
+static uint32_t refresh_seq;            // Incremented for every refresh
+
+// Wakes the render loop early (input, lvgl_port_wake())
+static K_SEM_DEFINE(wake_sem, 0, 1);
+
+// Set when LVGL invalidates an area (on-demand mode refreshes only then)
+static bool dirty;
+
+#ifdef CONFIG_LVGL_PORT_INPUT
+
+// Input subsystem -> render loop, read through an event-mode keypad
+K_MSGQ_DEFINE(key_msgq, sizeof(struct key_event), CONFIG_LVGL_PORT_INPUT_QUEUE_LEN, 4);
+INPUT_CALLBACK_DEFINE(NULL, input_cb, NULL);
+static lv_indev_t *keypad;
+static uint32_t last_key;
+
+// Oldest press not yet on the panel (0: none) and the refresh it waits for
+static uint32_t press_stamp;
+static uint32_t press_seq;
+#endif
+
+#ifdef CONFIG_LVGL_PORT_DOUBLE_BUFFER
+
+// Second buffer: LVGL renders into one while the other is sent
+static uint8_t render_buf2[BUF_SIZE] __aligned(LV_DRAW_BUF_ALIGN);
+#define RENDER_BUF2 render_buf2
+
+// One flush in flight at a time (LVGL waits before handing over the next).
+// The area is copied: LVGL may pass a temporary.
+static lv_area_t job_area;
+static uint8_t *job_px_map;
+static uint32_t job_seq;
+static bool job_last;
+static K_SEM_DEFINE(flush_start_sem, 0, 1);
+static K_SEM_DEFINE(flush_done_sem, 0, 1);
+
+K_THREAD_DEFINE(lvgl_flush_thread,
+                CONFIG_LVGL_PORT_FLUSH_THREAD_STACK_SIZE,
+                flush_thread_start,
+                NULL,
+                NULL,
+                NULL,
+                CONFIG_LVGL_PORT_FLUSH_THREAD_PRIORITY,
+                0,
+                0);
+#else
+#define RENDER_BUF2 NULL
+#endif
+
+//------------------------------------------------------------------------------
+// Private functions
+
+// Write one area to the panel (blocks until the transfer is done)
+static void panel_write(const lv_area_t *area, uint8_t *px_map)
+{
+    uint16_t w = lv_area_get_width(area);
+    uint16_t h = lv_area_get_height(area);
+    struct display_buffer_descriptor desc = {
+        .buf_size = (uint32_t)w * h * 2,
+        .width = w,
+        .height = h,
+        .pitch = w,
+    };
+    uint32_t start = k_cycle_get_32();
+    int ret;
+
+    ret = display_write(display_dev, area->x1, area->y1, &desc, px_map);
+    if (ret < 0) {
+        LOG_ERR("Error (%d): display write failed", ret);
+    }
+
+    // Stand-in for the bus time of a real panel (e.g. on the dummy display)
+    if (CONFIG_LVGL_PORT_EMUL_PIXEL_NS > 0) {
+        k_usleep((uint32_t)w * h * CONFIG_LVGL_PORT_EMUL_PIXEL_NS / 1000);
+    }
+
+    atomic_add(&flush_cyc, (atomic_val_t)(k_cycle_get_32() - start));
+}
+
+// Send one rendered area to the panel. LVGL has already merged the dirty
+// areas, so only those pixels (split into buffer-sized stripes) go out.
+static void flush_cb(lv_display_t *disp, const lv_area_t *area, uint8_t *px_map)
+{
+    uint32_t num_pixels = (uint32_t)lv_area_get_width(area) * lv_area_get_height(area);
+#ifndef CONFIG_LVGL_PORT_DOUBLE_BUFFER
+    uint32_t start;
+#endif
+
+    // The panel expects big-endian RGB565 over SPI
+    if (IS_ENABLED(CONFIG_LV_COLOR_16_SWAP)) {
+        lv_draw_sw_rgb565_swap(px_map, num_pixels);
+    }
+
+#ifdef CONFIG_LVGL_PORT_DOUBLE_BUFFER
+
+    // Hand the buffer to the flush thread and return to rendering. LVGL
+    // calls flush_wait_cb() before it needs this buffer again.
+    job_area = *area;
+    job_px_map = px_map;
+    job_seq = refresh_seq;
+    job_last = lv_display_flush_is_last(disp);
+    k_sem_give(&flush_start_sem);
+#else
+    start = k_cycle_get_32();
+    panel_write(area, px_map);
+    frame_blocked_cyc += k_cycle_get_32() - start;
+    if (lv_display_flush_is_last(disp)) {
+        frame_flushed(refresh_seq);
+    }
+#endif
+
+    frame_areas++;
+    frame_pixels += num_pixels;
+
+    // Close the frame after its last area
+    if (lv_display_flush_is_last(disp)) {
+        stats.frames++;
+        stats.areas += frame_areas;
+        stats.pixels += frame_pixels;
+        stats.last_frame_areas = frame_areas;
+        stats.last_frame_pixels = frame_pixels;
+        if (frame_pixels > stats.max_frame_pixels) {
+            stats.max_frame_pixels = frame_pixels;
+        }
+        frame_areas = 0;
+        frame_pixels = 0;
+    }
+
+#ifndef CONFIG_LVGL_PORT_DOUBLE_BUFFER
+    lv_display_flush_ready(disp);
+#endif
+}
+
+#ifdef CONFIG_LVGL_PORT_DOUBLE_BUFFER
+
+// LVGL waits for the previous flush: sleep instead of spinning on the flag
+// (LVGL clears it once this returns, so lv_display_flush_ready() is unused)
+static void flush_wait_cb(lv_display_t *disp)
+{
+    uint32_t start = k_cycle_get_32();
+
+    k_sem_take(&flush_done_sem, K_FOREVER);
+    frame_blocked_cyc += k_cycle_get_32() - start;
+}
+
+// Flush thread: runs the blocking display_write() while LVGL renders the
+// next stripe into the other buffer
+static void flush_thread_start(void *arg1, void *arg2, void *arg3)
+{
+    while (1) {
+        k_sem_take(&flush_start_sem, K_FOREVER);
+        panel_write(&job_area, job_px_map);
+        if (job_last) {
+            frame_flushed(job_seq);
+        }
+        k_sem_give(&flush_done_sem);
+    }
+}
+
+#endif /* CONFIG_LVGL_PORT_DOUBLE_BUFFER */
+
+// The last stripe of a refresh is on the panel: if a key press caused
+// that refresh, record how long it took to get there
+static void frame_flushed(uint32_t seq)
+{
+#ifdef CONFIG_LVGL_PORT_INPUT
+    uint32_t stamp = press_stamp;
+
+    if ((stamp != 0) && ((int32_t)(seq - press_seq) >= 0)) {
+        press_stamp = 0;
+        stats.latency_samples++;
+        stat_update(k_cyc_to_us_floor32(k_cycle_get_32() - stamp),
+                    &stats.last_latency_us,
+                    &stats.max_latency_us,
+                    &stats.total_latency_us);
+    }
+#endif
+}
+
+// Record one timing sample
+static void stat_update(uint32_t us, uint32_t *last, uint32_t *max, uint64_t *total)
+{
+    *last = us;
+    if (us > *max) {
+        *max = us;
+    }
+    *total += us;
+}
+
+// Render and flush the invalidated areas, timing both
+static void refresh(void)
+{
+    uint32_t refr_start;
+    uint32_t refr_cyc;
+    uint32_t frame_flush_cyc;
+
+    refresh_seq++;
+    stats.refreshes++;
+    frame_blocked_cyc = 0;
+
+    refr_start = k_cycle_get_32();
+    lv_display_refr_timer(NULL);
+    refr_cyc = k_cycle_get_32() - refr_start;
+
+    // With double buffering the last stripe may still be in flight,
+    // its flush time then counts towards the next frame
+    frame_flush_cyc = (uint32_t)atomic_clear(&flush_cyc);
+
+    stat_update(k_cyc_to_us_floor32(refr_cyc - frame_blocked_cyc),
+                &stats.last_render_us,
+                &stats.max_render_us,
+                &stats.total_render_us);
+    stat_update(k_cyc_to_us_floor32(frame_flush_cyc),
+                &stats.last_flush_us,
+                &stats.max_flush_us,
+                &stats.total_flush_us);
+}
+
+// Display event: something was invalidated and needs a refresh
+static void invalidate_cb(lv_event_t *e)
+{
+    dirty = true;
+}
+
+#ifdef CONFIG_LVGL_PORT_INPUT
+
+// Translate input subsystem key codes to LVGL keys (0: not handled)
+static uint32_t key_map(uint16_t code)
+{
+    switch (code) {
+    case INPUT_KEY_ENTER:
+    case INPUT_KEY_OK:
+        return LV_KEY_ENTER;
+    case INPUT_KEY_UP:
+        return LV_KEY_UP;
+    case INPUT_KEY_DOWN:
+        return LV_KEY_DOWN;
+    case INPUT_KEY_LEFT:
+        return LV_KEY_LEFT;
+    case INPUT_KEY_RIGHT:
+        return LV_KEY_RIGHT;
+    case INPUT_KEY_ESC:
+    case INPUT_KEY_BACK:
+        return LV_KEY_ESC;
+    case INPUT_KEY_TAB:
+        return LV_KEY_NEXT;
+    default:
+        return 0;
+    }
+}
+
+// Input subsystem callback (input thread): queue the key and wake the loop
+static void input_cb(struct input_event *evt, void *user_data)
+{
+    struct key_event ev;
+
+    if (evt->type != INPUT_EV_KEY) {
+        return;
+    }
+
+    ev.key = key_map(evt->code);
+    if (ev.key == 0) {
+        return;
+    }
+    ev.pressed = (evt->value != 0) ? 1 : 0;
+    ev.stamp = k_cycle_get_32() | 1U;
+
+    if (k_msgq_put(&key_msgq, &ev, K_NO_WAIT) < 0) {
+        LOG_WRN("Key event dropped");
+        return;
+    }
+    k_sem_give(&wake_sem);
+}
+
+// Keypad read callback: hand LVGL one queued key event per call
+static void keypad_read_cb(lv_indev_t *indev, lv_indev_data_t *data)
+{
+    struct key_event ev;
+
+    if (k_msgq_get(&key_msgq, &ev, K_NO_WAIT) < 0) {
+        data->key = last_key;
+        data->state = LV_INDEV_STATE_RELEASED;
+        return;
+    }
+
+    last_key = ev.key;
+    data->key = ev.key;
+    data->state = ev.pressed ? LV_INDEV_STATE_PRESSED : LV_INDEV_STATE_RELEASED;
+    data->continue_reading = (k_msgq_num_used_get(&key_msgq) > 0);
+
+    // Time the first press that has not reached the panel yet
+    if (ev.pressed) {
+        stats.input_events++;
+        if (press_stamp == 0) {
+            press_seq = refresh_seq + 1;
+            compiler_barrier();
+            press_stamp = ev.stamp;
+        }
+    }
+}
+
+#endif /* CONFIG_LVGL_PORT_INPUT */
+
+// Feed queued input to LVGL (the keypad is in event mode, never polled)
+static void input_process(void)
+{
+#ifdef CONFIG_LVGL_PORT_INPUT
+    if (k_msgq_num_used_get(&key_msgq) > 0) {
+        lv_indev_read(keypad);
+    }
+#endif
+}
+
+//------------------------------------------------------------------------------
+// Public functions (API)
+
+// Initialize LVGL and register the chosen zephyr,display with it
+int lvgl_port_init(void)
+{
+    struct display_capabilities caps;
+    int ret;
+
+    if (!device_is_ready(display_dev)) {
+        LOG_ERR("Display device is not ready");
+        return -ENODEV;
+    }
+
+    // Render 16-bit colour, switching the panel over if it supports it
+    // (BGR_565 panels get the same buffer, byte order is CONFIG_LV_COLOR_16_SWAP)
+    display_get_capabilities(display_dev, &caps);
+    if ((caps.current_pixel_format != PIXEL_FORMAT_RGB_565) &&
+        (caps.current_pixel_format != PIXEL_FORMAT_BGR_565)) {
+        ret = display_set_pixel_format(display_dev, PIXEL_FORMAT_RGB_565);
+        if (ret < 0) {
+            LOG_ERR("Display does not support RGB565");
+            return -ENOTSUP;
+        }
+    }
+
+    // Same start-up sequence as Zephyr's automatic LVGL init
+#ifdef CONFIG_LV_Z_MEM_POOL_SYS_HEAP
+    lvgl_heap_init();
+#endif
+    lv_init();
+    lv_tick_set_cb(k_uptime_get_32);
+
+    display = lv_display_create(DISPLAY_WIDTH, DISPLAY_HEIGHT);
+    if (display == NULL) {
+        LOG_ERR("Could not create LVGL display");
+        return -ENOMEM;
+    }
+    lv_display_set_color_format(display, LV_COLOR_FORMAT_RGB565);
+    lv_display_set_buffers(display,
+                           render_buf,
+                           RENDER_BUF2,
+                           sizeof(render_buf),
+                           LV_DISPLAY_RENDER_MODE_PARTIAL);
+    lv_display_set_flush_cb(display, flush_cb);
+#ifdef CONFIG_LVGL_PORT_DOUBLE_BUFFER
+    lv_display_set_flush_wait_cb(display, flush_wait_cb);
+#endif
+    lv_display_add_event_cb(display, invalidate_cb, LV_EVENT_INVALIDATE_AREA, NULL);
+
+#ifdef CONFIG_LVGL_PORT_INPUT
+    keypad = lv_indev_create();
+    lv_indev_set_type(keypad, LV_INDEV_TYPE_KEYPAD);
+    lv_indev_set_read_cb(keypad, keypad_read_cb);
+    lv_indev_set_mode(keypad, LV_INDEV_MODE_EVENT);
+#endif
+
+    stats.panel_pixels = DISPLAY_WIDTH * DISPLAY_HEIGHT;
+
+    LOG_DBG("%ux%u display, %u %u-row render buffer(s)",
+            DISPLAY_WIDTH,
+            DISPLAY_HEIGHT,
+            IS_ENABLED(CONFIG_LVGL_PORT_DOUBLE_BUFFER) ? 2 : 1,
+            BUF_ROWS);
+
+    return 0;
+}
+
+// Run LVGL forever at a fixed frame period. Frame deadlines are absolute
+// (start + n * period), so the time spent rendering does not stretch the
+// period; between frames the thread sleeps until the next frame or the next
+// LVGL timer, whichever comes first.
+void lvgl_port_run(uint32_t period_ms, lvgl_port_frame_cb_t frame_cb, void *user_data)
+{
+    const int64_t period_ticks = MAX(k_ms_to_ticks_ceil64(period_ms), 1);
+    int64_t next_frame = k_uptime_ticks();
+    int64_t now;
+    int64_t wake;
+    int64_t late;
+    uint32_t next_timer_ms;
+    uint32_t start;
+    uint32_t frame = 0;
+
+    // Refresh only on our frame deadlines instead of LVGL's own refresh timer
+    lv_display_delete_refr_timer(display);
+
+    while (1) {
+        now = k_uptime_ticks();
+
+        if (now >= next_frame) {
+
+            // Whole periods that passed without a frame were dropped
+            late = (now - next_frame) / period_ticks;
+            stats.dropped += (uint32_t)late;
+            next_frame += (late + 1) * period_ticks;
+            stats.periods++;
+
+            start = k_cycle_get_32();
+            if (frame_cb != NULL) {
+                frame_cb(frame++, user_data);
+            }
+            input_process();
+            lv_timer_handler();
+            refresh();
+            dirty = false;
+
+            stat_update(k_cyc_to_us_floor32(k_cycle_get_32() - start),
+                        &stats.last_frame_us,
+                        &stats.max_frame_us,
+                        &stats.total_frame_us);
+        }
+
+        // Keep LVGL timers (animations, input) running between frames
+        input_process();
+        next_timer_ms = lv_timer_handler();
+
+        wake = next_frame;
+        if (next_timer_ms != LV_NO_TIMER_READY) {
+            wake = MIN(wake, k_uptime_ticks() + k_ms_to_ticks_ceil64(next_timer_ms));
+        }
+        k_sem_take(&wake_sem, K_TIMEOUT_ABS_TICKS(wake));
+    }
+}
+
+// Run LVGL forever, refreshing only when something was invalidated. The
+// thread sleeps until input arrives, lvgl_port_wake() is called or an LVGL
+// timer is due; with no timers running a static screen costs no CPU.
+void lvgl_port_run_on_demand(lvgl_port_frame_cb_t wake_cb, void *user_data)
+{
+    uint32_t next_timer_ms;
+    uint32_t wakeup = 0;
+
+    // Refresh from this loop only, LVGL's refresh timer would poll
+    lv_display_delete_refr_timer(display);
+    dirty = true;
+
+    while (1) {
+        stats.wakeups++;
+
+        if (wake_cb != NULL) {
+            wake_cb(wakeup++, user_data);
+        }
+        input_process();
+        next_timer_ms = lv_timer_handler();
+
+        if (dirty) {
+            dirty = false;
+            refresh();
+        }
+
+        k_sem_take(&wake_sem,
+                   (next_timer_ms == LV_NO_TIMER_READY) ? K_FOREVER
+                                                        : K_MSEC(next_timer_ms));
+    }
+}
+
+// Run one frame right away: input, LVGL timers and a refresh, timed like
+// the run loops. For callers that pace frames themselves (benchmarks,
+// simulations); do not mix with the run loops.
+void lvgl_port_step(void)
+{
+    static bool own_refresh;
+
+    // Refresh from here only, LVGL's refresh timer would render as well
+    if (!own_refresh) {
+        lv_display_delete_refr_timer(display);
+        own_refresh = true;
+    }
+
+    input_process();
+    lv_timer_handler();
+    refresh();
+    dirty = false;
+}
+
+// Wake the render loop (e.g. after queuing work for it), callable from any
+// thread or ISR
+void lvgl_port_wake(void)
+{
+    k_sem_give(&wake_sem);
+}
+
+#ifdef CONFIG_LVGL_PORT_INPUT
+
+// Get the keypad input device (to assign it a group)
+lv_indev_t *lvgl_port_keypad_get(void)
+{
+    return keypad;
+}
+
+#endif
+
+// Get a snapshot of the statistics (call from the LVGL thread)
+void lvgl_port_stats_get(struct lvgl_port_stats *stats_out)
+{
+    *stats_out = stats;
+}
+
+// Print the statistics since the previous call: the render loop line only
+// when lvgl_port_run() ran periods, the bus line when frames were flushed
+// and the latency line when a new key press reached the panel
+void lvgl_port_stats_print(void)
+{
+    static struct lvgl_port_stats prev;
+    uint32_t periods = stats.periods - prev.periods;
+    uint32_t frames = stats.frames - prev.frames;
+    uint32_t frame_us;
+
+    if (periods > 0) {
+        frame_us = (uint32_t)((stats.total_frame_us - prev.total_frame_us) / periods);
+        printk("%u FPS (%u possible), dropped %u, frame %u us (max %u), "
+               "render %u us (max %u), flush %u us (max %u)\r\n",
+               periods,
+               (frame_us > 0) ? (1000000 / frame_us) : 0,
+               stats.dropped - prev.dropped,
+               frame_us,
+               stats.max_frame_us,
+               (uint32_t)((stats.total_render_us - prev.total_render_us) / periods),
+               stats.max_render_us,
+               (uint32_t)((stats.total_flush_us - prev.total_flush_us) / periods),
+               stats.max_flush_us);
+    }
+
+    // Report what the interval cost on the bus
+    if (frames > 0) {
+        printk("%u frames, %u areas/frame, %u px/frame "
+               "(%u%% of panel), last %u px, max %u px\r\n",
+               frames,
+               (stats.areas - prev.areas) / frames,
+               (uint32_t)((stats.pixels - prev.pixels) / frames),
+               (uint32_t)((stats.pixels - prev.pixels) * 100 /
+                          ((uint64_t)frames * stats.panel_pixels)),
+               stats.last_frame_pixels,
+               stats.max_frame_pixels);
+    }
+
+    if (stats.latency_samples != prev.latency_samples) {
+        printk("Press to pixels: last %u us, max %u us, avg %u us "
+               "(%u wakeups, %u refreshes, %u frames for %u presses)\r\n",
+               stats.last_latency_us,
+               stats.max_latency_us,
+               (uint32_t)(stats.total_latency_us / stats.latency_samples),
+               stats.wakeups,
+               stats.refreshes,
+               stats.frames,
+               stats.input_events);
+    }
+
+    prev = stats;
+}
@@ -0,0 +1,76 @@
+#ifndef LVGL_PORT_H_
+#define LVGL_PORT_H_
+
+#include <stdint.h>
+#include <lvgl.h>
+
+// Called once per frame period, before LVGL renders the frame
+typedef void (*lvgl_port_frame_cb_t)(uint32_t frame, void *user_data);
+
+// Flush and render loop statistics (running totals plus the most recent frame)
+struct lvgl_port_stats {
+    uint32_t frames;            // Frames flushed
+    uint32_t areas;             // display_write() calls
+    uint64_t pixels;            // Pixels pushed to the panel
+    uint32_t last_frame_areas;
+    uint32_t last_frame_pixels;
+    uint32_t max_frame_pixels;
+    uint32_t panel_pixels;      // Width * height, for comparison
+
+    // Render loop. Periods, drops and frame time are lvgl_port_run() only.
+    // Frame time covers the frame callback, LVGL timers and the refresh,
+    // render time is the refresh minus time spent waiting for the panel,
+    // and flush time is spent in display_write() (overlaps rendering with
+    // double buffering).
+    uint32_t periods;           // Frame periods run
+    uint32_t dropped;           // Frame deadlines missed
+    uint32_t last_frame_us;
+    uint32_t max_frame_us;
+    uint32_t last_render_us;
+    uint32_t max_render_us;
+    uint32_t last_flush_us;
+    uint32_t max_flush_us;
+    uint64_t total_frame_us;
+    uint64_t total_render_us;
+    uint64_t total_flush_us;
+
+    // On-demand loop and input. Latency runs from the key event to the
+    // last pixel of the refresh it caused being written to the panel.
+    uint32_t wakeups;           // Render loop wakeups
+    uint32_t refreshes;         // Refreshes started (frames above flushed)
+    uint32_t input_events;      // Key presses read by LVGL
+    uint32_t latency_samples;
+    uint32_t last_latency_us;
+    uint32_t max_latency_us;
+    uint64_t total_latency_us;
+};
+
+// Initialize LVGL and register the chosen zephyr,display with it
+int lvgl_port_init(void);
+
+// Run LVGL forever at a fixed frame period (never returns)
+void lvgl_port_run(uint32_t period_ms, lvgl_port_frame_cb_t frame_cb, void *user_data);
+
+// Run LVGL forever, refreshing only after invalidations (never returns).
+// wake_cb (optional) runs at every wakeup before input and timers.
+void lvgl_port_run_on_demand(lvgl_port_frame_cb_t wake_cb, void *user_data);
+
+// Run a single frame now (instead of the run loops, for benchmarks)
+void lvgl_port_step(void);
+
+// Wake the render loop early (any context)
+void lvgl_port_wake(void);
+
+#ifdef CONFIG_LVGL_PORT_INPUT
+// Get the keypad input device fed by the input subsystem
+lv_indev_t *lvgl_port_keypad_get(void);
+#endif
+
+// Get a snapshot of the statistics (call from the LVGL thread)
+void lvgl_port_stats_get(struct lvgl_port_stats *stats);
+
+// Print what changed in the statistics since the previous call (call from
+// the LVGL thread)
+void lvgl_port_stats_print(void);
+
+#endif /* LVGL_PORT_H_ */
@@ -0,0 +1,99 @@
+#include <errno.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/net/socket.h>
+
+#include "net_iov.h"
+
+// Enable logging at CONFIG_LOG_DEFAULT_LEVEL
+LOG_MODULE_REGISTER(net_iov);
+
+//------------------------------------------------------------------------------
+// Private functions
+
+// Drop the first n bytes of the list: whole pieces are skipped, a piece
+// that went out in part is trimmed in place
+static void consume(struct net_iov *iov, int *first, size_t n)
+{
+    iov->len -= n;
+    while ((*first < iov->count) && (n >= iov->vec[*first].iov_len)) {
+        n -= iov->vec[*first].iov_len;
+        (*first)++;
+    }
+    if (n > 0) {
+        iov->vec[*first].iov_base = (uint8_t *)iov->vec[*first].iov_base + n;
+        iov->vec[*first].iov_len -= n;
+    }
+}
+
+//------------------------------------------------------------------------------
+// Public functions (API)
+
+// Start an empty message
+void net_iov_init(struct net_iov *iov)
+{
+    iov->count = 0;
+    iov->len = 0;
+}
+
+// Append a piece
+int net_iov_add(struct net_iov *iov, const void *data, size_t len)
+{
+    if (len == 0) {
+        return 0;
+    }
+    if (iov->count >= CONFIG_NET_IOV_MAX) {
+        LOG_ERR("Error (%d): more than %d pieces", -ENOMEM, CONFIG_NET_IOV_MAX);
+        return -ENOMEM;
+    }
+
+    // sendmsg() never writes through iov_base, the cast only drops const
+    iov->vec[iov->count].iov_base = (void *)data;
+    iov->vec[iov->count].iov_len = len;
+    iov->count++;
+    iov->len += len;
+
+    return 0;
+}
+
+// Append a NUL-terminated string
+int net_iov_add_str(struct net_iov *iov, const char *str)
+{
+    return net_iov_add(iov, str, strlen(str));
+}
+
+// Send every piece with zsock_sendmsg()
+int net_iov_send(int sock, struct net_iov *iov, int flags)
+{
+    struct msghdr msg;
+    size_t sent = 0;
+    int first = 0;
+    ssize_t ret;
+
+    while (first < iov->count) {
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = &iov->vec[first];
+        msg.msg_iovlen = iov->count - first;
+
+        // A stream socket never takes zero bytes of a non-empty message
+        ret = zsock_sendmsg(sock, &msg, flags);
+        if (ret <= 0) {
+            ret = (ret < 0) ? -errno : -EIO;
+            break;
+        }
+        sent += ret;
+        consume(iov, &first, ret);
+    }
+
+    // Keep only what is left so a retry picks up where this stopped
+    if (first > 0) {
+        memmove(&iov->vec[0], &iov->vec[first], (iov->count - first) * sizeof(iov->vec[0]));
+        iov->count -= first;
+    }
+    if (iov->count > 0) {
+        return (int)ret;
+    }
+
+    return (int)sent;
+}
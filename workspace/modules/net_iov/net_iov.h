@@ -0,0 +1,32 @@
+#ifndef NET_IOV_H_
+#define NET_IOV_H_
+
+#include <stddef.h>
+#include <zephyr/net/socket.h>
+
+// A message as a list of pieces. Only pointers are stored: every piece
+// must stay valid until it has been sent.
+struct net_iov {
+    struct iovec vec[CONFIG_NET_IOV_MAX];
+    int count;
+    size_t len;     // Total bytes in all pieces
+};
+
+// Start an empty message
+void net_iov_init(struct net_iov *iov);
+
+// Append a piece (empty ones are skipped). Returns -ENOMEM if the message
+// already has CONFIG_NET_IOV_MAX pieces.
+int net_iov_add(struct net_iov *iov, const void *data, size_t len);
+
+// Append a NUL-terminated string (without the NUL)
+int net_iov_add_str(struct net_iov *iov, const char *str);
+
+// Send every piece, in order, with as few zsock_sendmsg() calls as the
+// stack allows (one unless it takes only part of the data). Returns the
+// number of bytes sent or a negative errno. The list is consumed as it
+// goes: after an error (e.g. -EAGAIN on a non-blocking socket) it holds
+// exactly what is left to send, so calling again resumes.
+int net_iov_send(int sock, struct net_iov *iov, int flags);
+
+#endif /* NET_IOV_H_ */
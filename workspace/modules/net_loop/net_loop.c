@@ -0,0 +1,351 @@
+#include <errno.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/net/socket.h>
+#include <zephyr/posix/fcntl.h>
+
+#include "net_loop.h"
+
+// Enable logging at CONFIG_LOG_DEFAULT_LEVEL
+LOG_MODULE_REGISTER(net_loop);
+
+//------------------------------------------------------------------------------
+// Forward declarations
+
+static int on_headers_complete(struct http_parser *parser);
+static int on_body(struct http_parser *parser, const char *at, size_t len);
+static int on_message_complete(struct http_parser *parser);
+static void txn_finish(struct net_loop *loop, struct net_txn *txn, int result);
+static void txn_connected(struct net_loop *loop, struct net_txn *txn);
+static void txn_send(struct net_loop *loop, struct net_txn *txn);
+static void txn_recv(struct net_loop *loop, struct net_txn *txn);
+static short txn_events(const struct net_txn *txn);
+
+//------------------------------------------------------------------------------
+// Globals
+
+// Every socket is read into this one buffer and handed on straight away, so
+// it is never shared between two transactions at the same time
+static uint8_t rx_buf[CONFIG_NET_LOOP_RX_BUF_SIZE];
+
+// HTTP parser hooks (parser.data is the transaction)
+static const struct http_parser_settings parser_settings = {
+    .on_headers_complete = on_headers_complete,
+    .on_body = on_body,
+    .on_message_complete = on_message_complete,
+};
+
+//------------------------------------------------------------------------------
+// Private functions
+
+static int on_headers_complete(struct http_parser *parser)
+{
+    struct net_txn *txn = parser->data;
+
+    txn->status = parser->status_code;
+
+    return 0;
+}
+
+static int on_body(struct http_parser *parser, const char *at, size_t len)
+{
+    struct net_txn *txn = parser->data;
+
+    if (txn->on_data != NULL) {
+        txn->on_data(txn, (const uint8_t *)at, len);
+    }
+
+    return 0;
+}
+
+static int on_message_complete(struct http_parser *parser)
+{
+    struct net_txn *txn = parser->data;
+
+    txn->complete = true;
+
+    return 0;
+}
+
+// End a transaction: close its socket, take it off the loop, report it
+static void txn_finish(struct net_loop *loop, struct net_txn *txn, int result)
+{
+    if (txn->sock >= 0) {
+        zsock_close(txn->sock);
+        txn->sock = -1;
+    }
+
+    for (int i = 0; i < loop->num_txns; i++) {
+        if (loop->txns[i] == txn) {
+            loop->txns[i] = loop->txns[--loop->num_txns];
+            break;
+        }
+    }
+
+    if (result == 0) {
+        loop->stats.completed++;
+    } else if (result == -ETIMEDOUT) {
+        loop->stats.timeouts++;
+    } else {
+        loop->stats.errors++;
+    }
+
+    txn->state = NET_TXN_DONE;
+    txn->result = result;
+    txn->elapsed_ms = (uint32_t)(k_uptime_get() - txn->start_ms);
+    if (txn->on_done != NULL) {
+        txn->on_done(txn, result);
+    }
+}
+
+// The socket became writable while connecting: see whether it worked
+static void txn_connected(struct net_loop *loop, struct net_txn *txn)
+{
+    int err = 0;
+    socklen_t len = sizeof(err);
+
+    if (zsock_getsockopt(txn->sock, SOL_SOCKET, SO_ERROR, &err, &len) < 0) {
+        err = errno;
+    }
+    if (err != 0) {
+        LOG_ERR("Error (%d): could not connect", -err);
+        txn_finish(loop, txn, -err);
+        return;
+    }
+
+    txn->state = NET_TXN_SENDING;
+    txn_send(loop, txn);
+}
+
+// Send as much of the request as the socket takes now
+static void txn_send(struct net_loop *loop, struct net_txn *txn)
+{
+    ssize_t ret;
+
+    while (txn->sent < txn->req_len) {
+        ret = zsock_send(txn->sock, txn->req + txn->sent, txn->req_len - txn->sent, 0);
+        if (ret < 0) {
+            if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) {
+                return;
+            }
+            txn_finish(loop, txn, -errno);
+            return;
+        }
+        txn->sent += ret;
+    }
+
+    txn->state = NET_TXN_RECEIVING;
+}
+
+// Read what has arrived. Plain TCP transactions end when the server closes
+// the connection, HTTP ones when the message is complete.
+static void txn_recv(struct net_loop *loop, struct net_txn *txn)
+{
+    ssize_t len;
+    size_t parsed;
+
+    while (1) {
+        len = zsock_recv(txn->sock, rx_buf, sizeof(rx_buf), 0);
+        if (len < 0) {
+            if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) {
+                return;
+            }
+            txn_finish(loop, txn, -errno);
+            return;
+        }
+        txn->rx_bytes += len;
+
+        if (!txn->http) {
+            if (len == 0) {
+                txn_finish(loop, txn, 0);
+                return;
+            }
+            if (txn->on_data != NULL) {
+                txn->on_data(txn, rx_buf, len);
+            }
+            continue;
+        }
+
+        // A zero length tells the parser the connection closed, which ends
+        // responses that have no length
+        parsed = http_parser_execute(&txn->parser, &parser_settings, (const char *)rx_buf, len);
+        if ((parsed != (size_t)len) || (HTTP_PARSER_ERRNO(&txn->parser) != HPE_OK)) {
+            LOG_ERR("Error: bad HTTP response (%s)",
+                    http_errno_name(HTTP_PARSER_ERRNO(&txn->parser)));
+            txn_finish(loop, txn, -EBADMSG);
+            return;
+        }
+        if (txn->complete) {
+            txn_finish(loop, txn, 0);
+            return;
+        }
+        if (len == 0) {
+            txn_finish(loop, txn, -ECONNRESET);
+            return;
+        }
+    }
+}
+
+// What to wait for on a transaction's socket
+static short txn_events(const struct net_txn *txn)
+{
+    switch (txn->state) {
+    case NET_TXN_CONNECTING:
+    case NET_TXN_SENDING:
+        return ZSOCK_POLLOUT;
+    case NET_TXN_RECEIVING:
+        return ZSOCK_POLLIN;
+    default:
+        return 0;
+    }
+}
+
+//------------------------------------------------------------------------------
+// Public functions (API)
+
+// Set up an empty loop
+void net_loop_init(struct net_loop *loop)
+{
+    memset(loop, 0, sizeof(*loop));
+}
+
+// Open a non-blocking socket for the transaction and start connecting
+int net_loop_add(struct net_loop *loop, struct net_txn *txn)
+{
+    int ret;
+
+    if (loop->num_txns >= CONFIG_NET_LOOP_MAX_TXNS) {
+        return -ENOSPC;
+    }
+
+    txn->state = NET_TXN_CONNECTING;
+    txn->result = 0;
+    txn->status = 0;
+    txn->rx_bytes = 0;
+    txn->elapsed_ms = 0;
+    txn->sent = 0;
+    txn->complete = false;
+    txn->start_ms = k_uptime_get();
+    if (txn->http) {
+        http_parser_init(&txn->parser, HTTP_RESPONSE);
+        txn->parser.data = txn;
+    }
+
+    txn->sock = zsock_socket(txn->addr.ss_family, SOCK_STREAM, IPPROTO_TCP);
+    if (txn->sock < 0) {
+        ret = -errno;
+        LOG_ERR("Error (%d): could not create socket", ret);
+        return ret;
+    }
+
+    ret = zsock_fcntl(txn->sock, F_SETFL, O_NONBLOCK);
+    if (ret < 0) {
+        ret = -errno;
+        LOG_ERR("Error (%d): could not make socket non-blocking", ret);
+        zsock_close(txn->sock);
+        txn->sock = -1;
+        return ret;
+    }
+
+    // The connection normally completes later, when the socket is writable
+    ret = zsock_connect(txn->sock, (struct sockaddr *)&txn->addr, txn->addrlen);
+    if ((ret < 0) && (errno != EINPROGRESS)) {
+        ret = -errno;
+        LOG_ERR("Error (%d): could not connect", ret);
+        zsock_close(txn->sock);
+        txn->sock = -1;
+        return ret;
+    }
+
+    loop->txns[loop->num_txns++] = txn;
+    loop->stats.started++;
+    loop->stats.max_active = MAX(loop->stats.max_active, (uint32_t)loop->num_txns);
+
+    return 0;
+}
+
+// Wait for activity on any socket (or the nearest deadline) and handle it
+int net_loop_poll(struct net_loop *loop, int32_t timeout_ms)
+{
+    struct zsock_pollfd fds[CONFIG_NET_LOOP_MAX_TXNS];
+    struct net_txn *polled[CONFIG_NET_LOOP_MAX_TXNS];
+    int num_fds = loop->num_txns;
+    int64_t now = k_uptime_get();
+    int64_t left;
+    int ret;
+
+    if (num_fds == 0) {
+        return 0;
+    }
+
+    // Sleep no longer than the first deadline
+    for (int i = 0; i < num_fds; i++) {
+        polled[i] = loop->txns[i];
+        fds[i].fd = polled[i]->sock;
+        fds[i].events = txn_events(polled[i]);
+        fds[i].revents = 0;
+
+        left = MAX(polled[i]->start_ms + polled[i]->timeout_ms - now, 0);
+        if ((timeout_ms < 0) || (left < timeout_ms)) {
+            timeout_ms = (int32_t)left;
+        }
+    }
+
+    loop->stats.polls++;
+    ret = zsock_poll(fds, num_fds, timeout_ms);
+    if (ret < 0) {
+        LOG_ERR("Error (%d): poll failed", -errno);
+        return loop->num_txns;
+    }
+
+    // Handle each ready socket (finishing one does not move the others in
+    // polled[], only in loop->txns)
+    for (int i = 0; i < num_fds; i++) {
+        struct net_txn *txn = polled[i];
+
+        if (fds[i].revents == 0) {
+            continue;
+        }
+
+        if (fds[i].revents & ZSOCK_POLLNVAL) {
+            txn_finish(loop, txn, -EBADF);
+            continue;
+        }
+
+        // Errors and hang-ups are picked up by the call for the current state
+        switch (txn->state) {
+        case NET_TXN_CONNECTING:
+            txn_connected(loop, txn);
+            break;
+        case NET_TXN_SENDING:
+            txn_send(loop, txn);
+            break;
+        case NET_TXN_RECEIVING:
+            txn_recv(loop, txn);
+            break;
+        default:
+            break;
+        }
+    }
+
+    // Expire whatever is still running past its deadline
+    now = k_uptime_get();
+    for (int i = 0; i < num_fds; i++) {
+        struct net_txn *txn = polled[i];
+
+        if ((txn->state != NET_TXN_DONE) &&
+            ((now - txn->start_ms) >= txn->timeout_ms)) {
+            txn_finish(loop, txn, -ETIMEDOUT);
+        }
+    }
+
+    return loop->num_txns;
+}
+
+// Poll until every transaction has finished
+void net_loop_run(struct net_loop *loop)
+{
+    while (net_loop_poll(loop, SYS_FOREVER_MS) > 0) {
+    }
+}
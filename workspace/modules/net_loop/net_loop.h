@@ -0,0 +1,88 @@
+#ifndef NET_LOOP_H_
+#define NET_LOOP_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <zephyr/net/socket.h>
+#include <zephyr/net/http/parser.h>
+
+struct net_txn;
+
+// Called with each piece of the response (the de-chunked body for HTTP).
+// The data lives in the loop's shared buffer and is only valid during the
+// call.
+typedef void (*net_txn_data_cb_t)(struct net_txn *txn, const uint8_t *data, size_t len);
+
+// Called once when the transaction ends: 0 on success, else a negative
+// error code (-ETIMEDOUT if the deadline passed)
+typedef void (*net_txn_done_cb_t)(struct net_txn *txn, int result);
+
+// Transaction state
+enum net_txn_state {
+    NET_TXN_IDLE,
+    NET_TXN_CONNECTING,
+    NET_TXN_SENDING,
+    NET_TXN_RECEIVING,
+    NET_TXN_DONE,
+};
+
+// One request/response exchange on its own connection. Fill in the first
+// block, then hand it to net_loop_add(); it must stay valid until on_done.
+struct net_txn {
+    struct sockaddr_storage addr;
+    socklen_t addrlen;
+    const uint8_t *req;
+    size_t req_len;
+    int32_t timeout_ms;     // Whole exchange, from connect to last byte
+    bool http;              // Parse the response as HTTP/1.1
+    net_txn_data_cb_t on_data;
+    net_txn_done_cb_t on_done;
+    void *user_data;
+
+    // Set by the loop
+    enum net_txn_state state;
+    int result;
+    uint16_t status;        // HTTP status code
+    size_t rx_bytes;        // Bytes received (before HTTP decoding)
+    uint32_t elapsed_ms;
+    int sock;
+    size_t sent;
+    int64_t start_ms;
+    struct http_parser parser;
+    bool complete;
+};
+
+// Loop counters
+struct net_loop_stats {
+    uint32_t started;
+    uint32_t completed;
+    uint32_t timeouts;
+    uint32_t errors;
+    uint32_t polls;         // zsock_poll() calls
+    uint32_t max_active;    // Most transactions in flight at once
+};
+
+// A set of transactions driven by one thread
+struct net_loop {
+    struct net_txn *txns[CONFIG_NET_LOOP_MAX_TXNS];
+    int num_txns;
+    struct net_loop_stats stats;
+};
+
+// Set up an empty loop
+void net_loop_init(struct net_loop *loop);
+
+// Start a transaction (opens a non-blocking socket and begins connecting).
+// Returns 0, -ENOSPC if the loop is full, or the socket error. Failures
+// are returned here only, on_done is not called.
+int net_loop_add(struct net_loop *loop, struct net_txn *txn);
+
+// Wait up to timeout_ms for socket activity or a deadline and handle it.
+// Returns the number of transactions still in flight.
+int net_loop_poll(struct net_loop *loop, int32_t timeout_ms);
+
+// Poll until every transaction has finished
+void net_loop_run(struct net_loop *loop);
+
+#endif /* NET_LOOP_H_ */
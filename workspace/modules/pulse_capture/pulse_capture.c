@@ -0,0 +1,196 @@
+#include <errno.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+
+#include "pulse_capture.h"
+
+// Enable logging at CONFIG_LOG_DEFAULT_LEVEL
+LOG_MODULE_REGISTER(pulse_capture);
+
+// Free-running indices are masked into the ring
+BUILD_ASSERT(IS_POWER_OF_TWO(CONFIG_PULSE_CAPTURE_RING_SIZE),
+             "CONFIG_PULSE_CAPTURE_RING_SIZE must be a power of two");
+#define RING_MASK (CONFIG_PULSE_CAPTURE_RING_SIZE - 1)
+
+//------------------------------------------------------------------------------
+// Forward declarations
+
+static void pulse_capture_isr(const struct device *dev,
+                              struct gpio_callback *cb,
+                              uint32_t pins);
+static void drain_locked(struct pulse_capture *pc);
+static void drain_work_handler(struct k_work *work);
+
+//------------------------------------------------------------------------------
+// Private functions
+
+// GPIO callback (ISR): stamp the edge first, then read which edge it was.
+// Single producer, so a plain store followed by publishing head is enough.
+static void pulse_capture_isr(const struct device *dev,
+                              struct gpio_callback *cb,
+                              uint32_t pins)
+{
+    struct pulse_capture *pc = CONTAINER_OF(cb, struct pulse_capture, cb);
+    uint32_t stamp = k_cycle_get_32();
+    int level = gpio_pin_get_dt(&pc->spec);
+    uint32_t head = (uint32_t)atomic_get(&pc->head);
+
+    if ((head - (uint32_t)atomic_get(&pc->tail)) >= CONFIG_PULSE_CAPTURE_RING_SIZE) {
+        atomic_inc(&pc->overruns);
+        return;
+    }
+
+    // Bit 0 holds the level: one cycle of resolution is not worth a second word
+    pc->ring[head & RING_MASK] = (stamp & ~1U) | ((level > 0) ? 1U : 0U);
+    atomic_set(&pc->head, (atomic_val_t)(head + 1));
+}
+
+// Fold the captured edges into the window. Periods are measured rise to
+// rise, so one that straddles two drains (or two windows) still counts.
+static void drain_locked(struct pulse_capture *pc)
+{
+    uint32_t head = (uint32_t)atomic_get(&pc->head);
+    uint32_t tail = (uint32_t)atomic_get(&pc->tail);
+    uint32_t lost;
+
+    while (tail != head) {
+        uint32_t entry = pc->ring[tail & RING_MASK];
+        uint32_t stamp = entry & ~1U;
+        int level = entry & 1U;
+
+        tail++;
+        pc->win_edges++;
+
+        // Two edges that read the same level were a pulse shorter than the
+        // ISR latency: ignore the second one
+        if (level == pc->level) {
+            continue;
+        }
+        pc->level = level;
+
+        if (level) {
+
+            // Rising edge closes the period that started at last_rise
+            if (pc->have_rise) {
+                pc->win_periods++;
+                pc->win_period_cycles += stamp - pc->last_rise;
+                pc->win_high_cycles += pc->high_cycles;
+            }
+            pc->last_rise = stamp;
+            pc->have_rise = true;
+            pc->high_cycles = 0;
+        } else if (pc->have_rise) {
+
+            // Falling edge ends the high part of the current period
+            pc->high_cycles = stamp - pc->last_rise;
+        }
+    }
+
+    // Hand the slots back to the ISR
+    atomic_set(&pc->tail, (atomic_val_t)tail);
+
+    // Lost edges break the rise-to-rise chain: resync on the next rising
+    // edge so the window only contains intact periods
+    lost = (uint32_t)atomic_clear(&pc->overruns);
+    if (lost > 0) {
+        pc->win_overruns += lost;
+        pc->have_rise = false;
+    }
+
+    // A rising edge more than half a cycle counter wrap old can no longer
+    // be told apart from a newer one
+    if (pc->have_rise && ((k_cycle_get_32() - pc->last_rise) > (UINT32_MAX / 2))) {
+        pc->have_rise = false;
+    }
+}
+
+// Work handler: empty the ring on a fixed interval so it never fills up
+static void drain_work_handler(struct k_work *work)
+{
+    struct k_work_delayable *dwork = k_work_delayable_from_work(work);
+    struct pulse_capture *pc = CONTAINER_OF(dwork, struct pulse_capture, drain_work);
+
+    k_mutex_lock(&pc->lock, K_FOREVER);
+    drain_locked(pc);
+    k_mutex_unlock(&pc->lock);
+
+    k_work_schedule(dwork, K_MSEC(CONFIG_PULSE_CAPTURE_DRAIN_MS));
+}
+
+//------------------------------------------------------------------------------
+// Public functions (API)
+
+// Configure the pin for both-edge interrupts and start capturing
+int pulse_capture_init(struct pulse_capture *pc, const struct gpio_dt_spec *spec)
+{
+    int ret;
+
+    if (!gpio_is_ready_dt(spec)) {
+        LOG_ERR("GPIO for pulse input is not ready");
+        return -ENODEV;
+    }
+
+    ret = gpio_pin_configure_dt(spec, GPIO_INPUT);
+    if (ret < 0) {
+        LOG_ERR("Error (%d): could not configure pulse input", ret);
+        return ret;
+    }
+
+    memset(pc, 0, sizeof(*pc));
+    pc->spec = *spec;
+    pc->level = (gpio_pin_get_dt(spec) > 0) ? 1 : 0;
+    k_mutex_init(&pc->lock);
+    k_work_init_delayable(&pc->drain_work, drain_work_handler);
+
+    gpio_init_callback(&pc->cb, pulse_capture_isr, BIT(spec->pin));
+    ret = gpio_add_callback(spec->port, &pc->cb);
+    if (ret < 0) {
+        LOG_ERR("Error (%d): could not add callback", ret);
+        return ret;
+    }
+
+    ret = gpio_pin_interrupt_configure_dt(spec, GPIO_INT_EDGE_BOTH);
+    if (ret < 0) {
+        LOG_ERR("Error (%d): could not configure interrupt", ret);
+        gpio_remove_callback(spec->port, &pc->cb);
+        return ret;
+    }
+
+    k_work_schedule(&pc->drain_work, K_MSEC(CONFIG_PULSE_CAPTURE_DRAIN_MS));
+
+    return 0;
+}
+
+// Compute the statistics of the window since the previous call
+void pulse_capture_measure(struct pulse_capture *pc, struct pulse_stats *stats)
+{
+    memset(stats, 0, sizeof(*stats));
+
+    k_mutex_lock(&pc->lock, K_FOREVER);
+
+    // Pick up the edges that arrived since the last drain
+    drain_locked(pc);
+
+    stats->edges = pc->win_edges;
+    stats->periods = pc->win_periods;
+    stats->overruns = pc->win_overruns;
+    if (pc->win_period_cycles > 0) {
+        stats->freq_mhz = (uint32_t)((uint64_t)pc->win_periods *
+                                     sys_clock_hw_cycles_per_sec() * 1000U /
+                                     pc->win_period_cycles);
+        stats->period_ns = (uint32_t)(k_cyc_to_ns_floor64(pc->win_period_cycles) /
+                                      pc->win_periods);
+        stats->duty_permille = (uint32_t)(pc->win_high_cycles * 1000U /
+                                          pc->win_period_cycles);
+    }
+
+    // Start the next window
+    pc->win_edges = 0;
+    pc->win_periods = 0;
+    pc->win_overruns = 0;
+    pc->win_period_cycles = 0;
+    pc->win_high_cycles = 0;
+
+    k_mutex_unlock(&pc->lock);
+}
@@ -0,0 +1,56 @@
+#ifndef PULSE_CAPTURE_H_
+#define PULSE_CAPTURE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/drivers/gpio.h>
+
+// Capture state for one input pin (treat the fields as private)
+struct pulse_capture {
+    struct gpio_dt_spec spec;
+    struct gpio_callback cb;
+
+    // Edge ring: cycle stamp with the pin level in bit 0. Written by the
+    // ISR only (head), read by the drain only (tail).
+    uint32_t ring[CONFIG_PULSE_CAPTURE_RING_SIZE];
+    atomic_t head;
+    atomic_t tail;
+    atomic_t overruns;
+
+    // Drain work and the lock shared with pulse_capture_measure()
+    struct k_work_delayable drain_work;
+    struct k_mutex lock;
+
+    // Edge tracking, carried from one drain to the next
+    uint32_t last_rise;         // Stamp of the most recent rising edge
+    uint32_t high_cycles;       // High time of the period in progress
+    bool have_rise;             // last_rise is valid
+    int level;                  // Level after the most recent edge
+
+    // Window accumulators, reset by pulse_capture_measure()
+    uint32_t win_edges;
+    uint32_t win_periods;
+    uint32_t win_overruns;
+    uint64_t win_period_cycles;
+    uint64_t win_high_cycles;
+};
+
+// Measurement over the window since the previous call
+struct pulse_stats {
+    uint32_t edges;             // Edges captured in the window
+    uint32_t periods;           // Complete periods (rise to rise)
+    uint32_t freq_mhz;          // Frequency (millihertz), 0 if no periods
+    uint32_t period_ns;         // Average period
+    uint32_t duty_permille;     // High time / period (0-1000)
+    uint32_t overruns;          // Edges dropped because the ring was full
+};
+
+// Configure the pin for both-edge interrupts and start capturing
+int pulse_capture_init(struct pulse_capture *pc, const struct gpio_dt_spec *spec);
+
+// Compute the statistics of the window since the previous call
+void pulse_capture_measure(struct pulse_capture *pc, struct pulse_stats *stats);
+
+#endif /* PULSE_CAPTURE_H_ */
@@ -0,0 +1,209 @@
+#include <string.h>
+
+#include "rgb565.h"
+
+// Blending spreads a pixel over 32 bits (green in the upper half, red and
+// blue in the lower) so every channel has 5 spare bits above it. One 32-bit
+// multiply-add then blends all three channels, with no per-channel shifts
+// or branches, which keeps the loops vectorizable.
+#define SPREAD_MASK 0x07E0F81FU
+
+//------------------------------------------------------------------------------
+// Private functions
+
+// Spread a pixel for blending
+static inline uint32_t spread(uint16_t c)
+{
+    return ((uint32_t)c | ((uint32_t)c << 16)) & SPREAD_MASK;
+}
+
+// Blend a spread foreground over a background pixel with 5-bit alpha
+static inline uint16_t mix(uint32_t fg, uint16_t bg, uint32_t a5)
+{
+    uint32_t x = ((fg * a5) + (spread(bg) * (32 - a5))) >> 5;
+
+    x &= SPREAD_MASK;
+
+    return (uint16_t)(x | (x >> 16));
+}
+
+// 8-bit opacity to 5-bit alpha (0-32), rounded so 255 is fully opaque
+static inline uint32_t alpha5(uint32_t a8)
+{
+    return (a8 + 4) >> 3;
+}
+
+// Row pointer helpers (strides are in bytes)
+static inline uint16_t *row16(void *buf, int32_t stride, int32_t y)
+{
+    return (uint16_t *)((uint8_t *)buf + (size_t)stride * y);
+}
+
+static inline const uint16_t *row16_const(const void *buf, int32_t stride, int32_t y)
+{
+    return (const uint16_t *)((const uint8_t *)buf + (size_t)stride * y);
+}
+
+//------------------------------------------------------------------------------
+// Public functions (API)
+
+// Fill a rectangle: one pixel to reach word alignment, then two pixels per
+// 32-bit store
+void rgb565_fill(void *dst,
+                 int32_t dst_stride,
+                 int32_t w,
+                 int32_t h,
+                 uint16_t color)
+{
+    const uint32_t color2 = ((uint32_t)color << 16) | color;
+
+    for (int32_t y = 0; y < h; y++) {
+        uint16_t *d = row16(dst, dst_stride, y);
+        int32_t n = w;
+        uint32_t *d32;
+
+        if ((n > 0) && ((uintptr_t)d & 2)) {
+            *d++ = color;
+            n--;
+        }
+        d32 = (uint32_t *)d;
+        for (int32_t i = 0; i < (n / 2); i++) {
+            d32[i] = color2;
+        }
+        if (n & 1) {
+            d[n - 1] = color;
+        }
+    }
+}
+
+// Copy a rectangle (one call for contiguous buffers, else one per row)
+void rgb565_copy(void *dst,
+                 int32_t dst_stride,
+                 const void *src,
+                 int32_t src_stride,
+                 int32_t w,
+                 int32_t h)
+{
+    const size_t row_bytes = (size_t)w * sizeof(uint16_t);
+
+    if ((dst_stride == (int32_t)row_bytes) && (src_stride == (int32_t)row_bytes)) {
+        memcpy(dst, src, row_bytes * h);
+        return;
+    }
+
+    for (int32_t y = 0; y < h; y++) {
+        memcpy(row16(dst, dst_stride, y), row16_const(src, src_stride, y), row_bytes);
+    }
+}
+
+// Blend one colour with a constant opacity
+void rgb565_blend_color(void *dst,
+                        int32_t dst_stride,
+                        int32_t w,
+                        int32_t h,
+                        uint16_t color,
+                        uint8_t opa)
+{
+    const uint32_t fg = spread(color);
+    const uint32_t a5 = alpha5(opa);
+
+    if (a5 == 0) {
+        return;
+    }
+    if (a5 == 32) {
+        rgb565_fill(dst, dst_stride, w, h, color);
+        return;
+    }
+
+    for (int32_t y = 0; y < h; y++) {
+        uint16_t *d = row16(dst, dst_stride, y);
+
+        for (int32_t x = 0; x < w; x++) {
+            d[x] = mix(fg, d[x], a5);
+        }
+    }
+}
+
+// Blend one colour through a coverage mask
+void rgb565_blend_color_mask(void *dst,
+                             int32_t dst_stride,
+                             int32_t w,
+                             int32_t h,
+                             uint16_t color,
+                             const uint8_t *mask,
+                             int32_t mask_stride,
+                             uint8_t opa)
+{
+    const uint32_t fg = spread(color);
+    const uint32_t scale = (uint32_t)opa + 1;
+
+    for (int32_t y = 0; y < h; y++) {
+        uint16_t *d = row16(dst, dst_stride, y);
+        const uint8_t *m = mask + (size_t)mask_stride * y;
+
+        for (int32_t x = 0; x < w; x++) {
+            d[x] = mix(fg, d[x], alpha5((m[x] * scale) >> 8));
+        }
+    }
+}
+
+// Blend an image with a constant opacity and an optional mask
+void rgb565_blend_image(void *dst,
+                        int32_t dst_stride,
+                        const void *src,
+                        int32_t src_stride,
+                        int32_t w,
+                        int32_t h,
+                        const uint8_t *mask,
+                        int32_t mask_stride,
+                        uint8_t opa)
+{
+    const uint32_t scale = (uint32_t)opa + 1;
+    const uint32_t a5 = alpha5(opa);
+
+    if ((mask == NULL) && (a5 == 32)) {
+        rgb565_copy(dst, dst_stride, src, src_stride, w, h);
+        return;
+    }
+
+    for (int32_t y = 0; y < h; y++) {
+        uint16_t *d = row16(dst, dst_stride, y);
+        const uint16_t *s = row16_const(src, src_stride, y);
+
+        if (mask == NULL) {
+            for (int32_t x = 0; x < w; x++) {
+                d[x] = mix(spread(s[x]), d[x], a5);
+            }
+        } else {
+            const uint8_t *m = mask + (size_t)mask_stride * y;
+
+            for (int32_t x = 0; x < w; x++) {
+                d[x] = mix(spread(s[x]), d[x], alpha5((m[x] * scale) >> 8));
+            }
+        }
+    }
+}
+
+// Swap bytes two pixels at a time
+void rgb565_swap(void *buf, size_t num_pixels)
+{
+    uint16_t *p = buf;
+    uint32_t *p32;
+
+    if ((num_pixels > 0) && ((uintptr_t)p & 2)) {
+        *p = (uint16_t)((*p << 8) | (*p >> 8));
+        p++;
+        num_pixels--;
+    }
+
+    p32 = (uint32_t *)p;
+    for (size_t i = 0; i < (num_pixels / 2); i++) {
+        uint32_t x = p32[i];
+
+        p32[i] = ((x & 0xFF00FF00U) >> 8) | ((x & 0x00FF00FFU) << 8);
+    }
+
+    if (num_pixels & 1) {
+        p[num_pixels - 1] = (uint16_t)((p[num_pixels - 1] << 8) | (p[num_pixels - 1] >> 8));
+    }
+}
@@ -0,0 +1,66 @@
+#ifndef RGB565_H_
+#define RGB565_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Pixel kernels for RGB565 framebuffers. Strides are in bytes and must be
+// even; rows may start at any 16-bit boundary. Blending uses 5-bit alpha
+// (33 levels), which is below what 5/6-bit colour channels can show.
+//
+// All kernels work in whatever byte order the buffer uses as long as the
+// colours passed in use the same order, except the blends, which do
+// arithmetic on the channels and need native order (byte-swapped panels
+// get swapped once at flush, see rgb565_swap()).
+
+// Fill a rectangle with one colour
+void rgb565_fill(void *dst,
+                 int32_t dst_stride,
+                 int32_t w,
+                 int32_t h,
+                 uint16_t color);
+
+// Copy a rectangle
+void rgb565_copy(void *dst,
+                 int32_t dst_stride,
+                 const void *src,
+                 int32_t src_stride,
+                 int32_t w,
+                 int32_t h);
+
+// Blend one colour over a rectangle with a constant opacity (0-255)
+void rgb565_blend_color(void *dst,
+                        int32_t dst_stride,
+                        int32_t w,
+                        int32_t h,
+                        uint16_t color,
+                        uint8_t opa);
+
+// Blend one colour through an 8-bit coverage mask (anti-aliased edges,
+// glyphs), scaled by a constant opacity
+void rgb565_blend_color_mask(void *dst,
+                             int32_t dst_stride,
+                             int32_t w,
+                             int32_t h,
+                             uint16_t color,
+                             const uint8_t *mask,
+                             int32_t mask_stride,
+                             uint8_t opa);
+
+// Blend an image over a rectangle with a constant opacity, optionally
+// through an 8-bit mask (NULL for none)
+void rgb565_blend_image(void *dst,
+                        int32_t dst_stride,
+                        const void *src,
+                        int32_t src_stride,
+                        int32_t w,
+                        int32_t h,
+                        const uint8_t *mask,
+                        int32_t mask_stride,
+                        uint8_t opa);
+
+// Swap the bytes of every pixel in a buffer (for SPI panels that take the
+// high byte first)
+void rgb565_swap(void *buf, size_t num_pixels);
+
+#endif /* RGB565_H_ */
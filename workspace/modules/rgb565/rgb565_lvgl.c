@@ -0,0 +1,49 @@
+#include <lvgl.h>
+
+#include "rgb565.h"
+#include "rgb565_lvgl.h"
+
+//------------------------------------------------------------------------------
+// Public functions (API)
+
+// Colour fill with optional opacity and mask
+lv_result_t rgb565_lv_fill(void *dest_buf,
+                           int32_t dest_w,
+                           int32_t dest_h,
+                           int32_t dest_stride,
+                           lv_color_t color,
+                           const lv_opa_t *mask_buf,
+                           int32_t mask_stride,
+                           lv_opa_t opa)
+{
+    uint16_t c = lv_color_to_u16(color);
+
+    if (mask_buf != NULL) {
+        rgb565_blend_color_mask(dest_buf, dest_stride, dest_w, dest_h,
+                                c, mask_buf, mask_stride, opa);
+    } else if (opa >= LV_OPA_MAX) {
+        rgb565_fill(dest_buf, dest_stride, dest_w, dest_h, c);
+    } else {
+        rgb565_blend_color(dest_buf, dest_stride, dest_w, dest_h, c, opa);
+    }
+
+    return LV_RESULT_OK;
+}
+
+// RGB565 image with optional opacity and mask
+lv_result_t rgb565_lv_blit(void *dest_buf,
+                           int32_t dest_w,
+                           int32_t dest_h,
+                           int32_t dest_stride,
+                           const void *src_buf,
+                           int32_t src_stride,
+                           const lv_opa_t *mask_buf,
+                           int32_t mask_stride,
+                           lv_opa_t opa)
+{
+    rgb565_blend_image(dest_buf, dest_stride, src_buf, src_stride,
+                       dest_w, dest_h, mask_buf, mask_stride,
+                       (mask_buf == NULL && opa >= LV_OPA_MAX) ? LV_OPA_COVER : opa);
+
+    return LV_RESULT_OK;
+}
@@ -0,0 +1,52 @@
+#ifndef RGB565_LVGL_H_
+#define RGB565_LVGL_H_
+
+// Hooks for LVGL's software renderer, included by its RGB565 blend code
+// through CONFIG_LV_DRAW_SW_ASM_CUSTOM_INCLUDE. Each hook gets the fields of
+// LVGL's blend descriptor and returns LV_RESULT_OK once the area is done.
+// Blend modes other than normal and other source formats stay with LVGL.
+
+#include <stdint.h>
+
+lv_result_t rgb565_lv_fill(void *dest_buf,
+                           int32_t dest_w,
+                           int32_t dest_h,
+                           int32_t dest_stride,
+                           lv_color_t color,
+                           const lv_opa_t *mask_buf,
+                           int32_t mask_stride,
+                           lv_opa_t opa);
+
+lv_result_t rgb565_lv_blit(void *dest_buf,
+                           int32_t dest_w,
+                           int32_t dest_h,
+                           int32_t dest_stride,
+                           const void *src_buf,
+                           int32_t src_stride,
+                           const lv_opa_t *mask_buf,
+                           int32_t mask_stride,
+                           lv_opa_t opa);
+
+#define RGB565_LV_FILL(dsc)                                                   \
+    rgb565_lv_fill((dsc)->dest_buf, (dsc)->dest_w, (dsc)->dest_h,             \
+                   (dsc)->dest_stride, (dsc)->color,                          \
+                   (dsc)->mask_buf, (dsc)->mask_stride, (dsc)->opa)
+
+#define RGB565_LV_BLIT(dsc)                                                   \
+    rgb565_lv_blit((dsc)->dest_buf, (dsc)->dest_w, (dsc)->dest_h,             \
+                   (dsc)->dest_stride, (dsc)->src_buf, (dsc)->src_stride,     \
+                   (dsc)->mask_buf, (dsc)->mask_stride, (dsc)->opa)
+
+// Colour fills onto RGB565
+#define LV_DRAW_SW_COLOR_BLEND_TO_RGB565(dsc)               RGB565_LV_FILL(dsc)
+#define LV_DRAW_SW_COLOR_BLEND_TO_RGB565_WITH_OPA(dsc)      RGB565_LV_FILL(dsc)
+#define LV_DRAW_SW_COLOR_BLEND_TO_RGB565_WITH_MASK(dsc)     RGB565_LV_FILL(dsc)
+#define LV_DRAW_SW_COLOR_BLEND_TO_RGB565_MIX_MASK_OPA(dsc)  RGB565_LV_FILL(dsc)
+
+// RGB565 images onto RGB565 (normal blend mode)
+#define LV_DRAW_SW_RGB565_BLEND_NORMAL_TO_RGB565(dsc)               RGB565_LV_BLIT(dsc)
+#define LV_DRAW_SW_RGB565_BLEND_NORMAL_TO_RGB565_WITH_OPA(dsc)      RGB565_LV_BLIT(dsc)
+#define LV_DRAW_SW_RGB565_BLEND_NORMAL_TO_RGB565_WITH_MASK(dsc)     RGB565_LV_BLIT(dsc)
+#define LV_DRAW_SW_RGB565_BLEND_NORMAL_TO_RGB565_MIX_MASK_OPA(dsc)  RGB565_LV_BLIT(dsc)
+
+#endif /* RGB565_LVGL_H_ */
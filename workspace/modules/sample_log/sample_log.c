@@ -0,0 +1,355 @@
+#include <errno.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/fs/fcb.h>
+#include <zephyr/storage/flash_map.h>
+
+#include "sample_log.h"
+
+// Enable logging at CONFIG_LOG_DEFAULT_LEVEL
+LOG_MODULE_REGISTER(sample_log);
+
+// Log settings
+#define LOG_PARTITION storage_partition
+#define LOG_MAGIC 0x534c4f47        // "SLOG"
+#define LOG_VERSION 1
+
+// FCB layout: each sector starts with an 8-byte header, each entry is a
+// length (2 bytes from 128 bytes up), the data and a CRC-8, every part
+// padded to the flash write block
+#define SECTOR_HDR_LEN 8
+#define ENTRY_LEN_LEN 2
+#define ENTRY_CRC_LEN 1
+#define ENTRY_MAX_LEN 0x3fff
+
+// Counts the undrained bytes in a sector that is about to be dropped
+struct lost_ctx {
+    uint32_t bytes;
+};
+
+//------------------------------------------------------------------------------
+// Forward declarations
+
+static uint32_t flash_len(size_t len);
+static uint32_t elapsed_us(uint32_t start);
+static int count_lost(struct fcb_entry_ctx *loc_ctx, void *arg);
+static int make_room(void);
+static int write_batch(void);
+
+//------------------------------------------------------------------------------
+// Globals
+
+static struct fcb fcb;
+static struct flash_sector sectors[CONFIG_SAMPLE_LOG_MAX_SECTORS];
+static K_MUTEX_DEFINE(log_lock);
+static bool ready;
+
+// Last entry handed out by sample_log_drain() (fe_sector is NULL before the
+// first one). Entries up to here sit in the active sector until it fills up
+// and can be erased as a whole; after a reboot they are sent again.
+static struct fcb_entry drain_loc;
+
+// Records waiting to be written as one entry. Drains flush it first and
+// then read entries back into it, so one buffer does both.
+static uint8_t batch[CONFIG_SAMPLE_LOG_BATCH_SIZE];
+static size_t batch_fill;
+static size_t batch_len;
+
+// Counters (under log_lock)
+static struct sample_log_stats stats;
+
+//------------------------------------------------------------------------------
+// Private functions
+
+// Bytes taken in flash once padded to the write block
+static uint32_t flash_len(size_t len)
+{
+    return ROUND_UP(len, fcb.f_align);
+}
+
+static uint32_t elapsed_us(uint32_t start)
+{
+    return k_cyc_to_us_floor32(k_cycle_get_32() - start);
+}
+
+// Sum the entries in the sector that have not been drained yet
+static int count_lost(struct fcb_entry_ctx *loc_ctx, void *arg)
+{
+    struct lost_ctx *ctx = arg;
+
+    if ((drain_loc.fe_sector != loc_ctx->loc.fe_sector) ||
+        (loc_ctx->loc.fe_elem_off > drain_loc.fe_elem_off)) {
+        ctx->bytes += loc_ctx->loc.fe_data_len;
+    }
+
+    return 0;
+}
+
+// The log is full: drop the oldest sector
+static int make_room(void)
+{
+    struct lost_ctx ctx = { 0 };
+    uint32_t size = (uint32_t)fcb.f_oldest->fs_size;
+    int ret;
+
+    fcb_walk(&fcb, fcb.f_oldest, count_lost, &ctx);
+    if (drain_loc.fe_sector == fcb.f_oldest) {
+        drain_loc.fe_sector = NULL;
+    }
+
+    ret = fcb_rotate(&fcb);
+    if (ret < 0) {
+        LOG_ERR("Error (%d): could not erase oldest sector", ret);
+        return ret;
+    }
+
+    LOG_WRN("Log full, dropped %u bytes", ctx.bytes);
+    stats.lost += ctx.bytes;
+    stats.pending -= MIN(stats.pending, ctx.bytes);
+    stats.erased += size;
+
+    return 0;
+}
+
+// Write the staged records as one entry, making room if needed
+static int write_batch(void)
+{
+    struct fcb_entry loc;
+    uint32_t start;
+    int ret;
+
+    if (batch_fill == 0) {
+        return 0;
+    }
+
+    start = k_cycle_get_32();
+    ret = fcb_append(&fcb, batch_fill, &loc);
+    if (ret == -ENOSPC) {
+        ret = make_room();
+        if (ret == 0) {
+            ret = fcb_append(&fcb, batch_fill, &loc);
+        }
+    }
+    if (ret < 0) {
+        LOG_ERR("Error (%d): could not allocate entry", ret);
+        return ret;
+    }
+
+    ret = flash_area_write(fcb.fap, FCB_ENTRY_FA_DATA_OFF(loc), batch, batch_fill);
+    if (ret < 0) {
+        LOG_ERR("Error (%d): could not write entry", ret);
+        return ret;
+    }
+
+    ret = fcb_append_finish(&fcb, &loc);
+    if (ret < 0) {
+        LOG_ERR("Error (%d): could not finish entry", ret);
+        return ret;
+    }
+    stats.write_us += elapsed_us(start);
+
+    // The first entry in a sector also writes the sector header
+    if (loc.fe_elem_off == flash_len(SECTOR_HDR_LEN)) {
+        stats.written += flash_len(SECTOR_HDR_LEN);
+    }
+    stats.written += flash_len(ENTRY_LEN_LEN) + flash_len(batch_fill) + flash_len(ENTRY_CRC_LEN);
+    stats.entries++;
+    stats.pending += batch_fill;
+    batch_fill = 0;
+
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+// Public functions (API)
+
+// Mount the log on the storage partition
+int sample_log_init(void)
+{
+    uint8_t id = FIXED_PARTITION_ID(LOG_PARTITION);
+    const struct flash_area *fa;
+    struct fcb_entry loc;
+    uint32_t cnt = ARRAY_SIZE(sectors);
+    uint32_t usable;
+    uint32_t overhead;
+    uint32_t per_sector;
+    int ret;
+
+    ret = flash_area_get_sectors(id, &cnt, sectors);
+    if (ret < 0) {
+        LOG_ERR("Error (%d): could not get partition sectors", ret);
+        return ret;
+    }
+
+    fcb.f_magic = LOG_MAGIC;
+    fcb.f_version = LOG_VERSION;
+    fcb.f_sector_cnt = cnt;
+    fcb.f_scratch_cnt = 0;
+    fcb.f_sectors = sectors;
+
+    // Anything that is not a log (or a damaged one) is wiped
+    ret = fcb_init(id, &fcb);
+    if (ret < 0) {
+        LOG_WRN("No usable log (%d), erasing partition", ret);
+        ret = flash_area_open(id, &fa);
+        if (ret == 0) {
+            ret = flash_area_erase(fa, 0, fa->fa_size);
+            flash_area_close(fa);
+        }
+        if (ret == 0) {
+            ret = fcb_init(id, &fcb);
+        }
+        if (ret < 0) {
+            LOG_ERR("Error (%d): could not init flash log", ret);
+            return ret;
+        }
+    }
+
+    // Size batches so a whole number of entries fills each sector exactly
+    usable = sectors[0].fs_size - flash_len(SECTOR_HDR_LEN);
+    overhead = flash_len(ENTRY_LEN_LEN) + flash_len(ENTRY_CRC_LEN);
+    per_sector = DIV_ROUND_UP(usable, MIN(CONFIG_SAMPLE_LOG_BATCH_SIZE, ENTRY_MAX_LEN) + overhead);
+    batch_len = ROUND_DOWN(usable / per_sector - overhead, fcb.f_align);
+
+    // Whatever survived a reboot is still to be sent
+    stats.pending = 0;
+    loc.fe_sector = NULL;
+    while (fcb_getnext(&fcb, &loc) == 0) {
+        stats.pending += loc.fe_data_len;
+    }
+    drain_loc.fe_sector = NULL;
+    batch_fill = 0;
+    ready = true;
+
+    stats.batch_len = batch_len;
+    stats.sector_size = sectors[0].fs_size;
+    stats.sector_count = cnt;
+    LOG_INF("%u sectors of %u bytes, %u-byte batches, %u bytes pending",
+            stats.sector_count,
+            stats.sector_size,
+            stats.batch_len,
+            stats.pending);
+
+    return 0;
+}
+
+// Stage a record, writing the batch out first if it does not fit
+int sample_log_append(const void *data, size_t len)
+{
+    int ret = 0;
+
+    if (!ready) {
+        return -ENODEV;
+    }
+    if ((len == 0) || (len > batch_len)) {
+        return -EINVAL;
+    }
+
+    k_mutex_lock(&log_lock, K_FOREVER);
+    if (batch_fill + len > batch_len) {
+        ret = write_batch();
+    }
+    if (ret == 0) {
+        memcpy(batch + batch_fill, data, len);
+        batch_fill += len;
+        stats.appended += len;
+    }
+    k_mutex_unlock(&log_lock);
+
+    return ret;
+}
+
+// Write the staged batch to flash now
+int sample_log_flush(void)
+{
+    int ret;
+
+    if (!ready) {
+        return -ENODEV;
+    }
+
+    k_mutex_lock(&log_lock, K_FOREVER);
+    ret = write_batch();
+    k_mutex_unlock(&log_lock);
+
+    return ret;
+}
+
+// Hand stored batches to cb oldest first, erasing each sector once it has
+// been drained completely
+int sample_log_drain(sample_log_drain_cb_t cb, void *user_data)
+{
+    struct fcb_entry loc;
+    uint32_t start;
+    uint32_t size;
+    int drained = 0;
+    int ret;
+
+    if (!ready) {
+        return -ENODEV;
+    }
+
+    k_mutex_lock(&log_lock, K_FOREVER);
+    ret = write_batch();
+
+    while (ret == 0) {
+        loc = drain_loc;
+        if (fcb_getnext(&fcb, &loc) != 0) {
+            break;
+        }
+
+        start = k_cycle_get_32();
+        ret = flash_area_read(fcb.fap, FCB_ENTRY_FA_DATA_OFF(loc), batch, loc.fe_data_len);
+        if (ret < 0) {
+            LOG_ERR("Error (%d): could not read entry", ret);
+            break;
+        }
+        stats.read_us += elapsed_us(start);
+
+        // Stop at the first batch the caller could not forward
+        if (cb(batch, loc.fe_data_len, user_data) < 0) {
+            break;
+        }
+        drain_loc = loc;
+        drained += loc.fe_data_len;
+        stats.drained += loc.fe_data_len;
+        stats.pending -= MIN(stats.pending, loc.fe_data_len);
+
+        // Every sector before this one is done with
+        while (fcb.f_oldest != drain_loc.fe_sector) {
+            size = (uint32_t)fcb.f_oldest->fs_size;
+            start = k_cycle_get_32();
+            ret = fcb_rotate(&fcb);
+            if (ret < 0) {
+                LOG_ERR("Error (%d): could not erase drained sector", ret);
+                break;
+            }
+            stats.write_us += elapsed_us(start);
+            stats.erased += size;
+        }
+    }
+    k_mutex_unlock(&log_lock);
+
+    return (ret < 0) ? ret : drained;
+}
+
+// True if nothing is waiting, in flash or staged
+bool sample_log_is_empty(void)
+{
+    bool empty;
+
+    k_mutex_lock(&log_lock, K_FOREVER);
+    empty = (stats.pending == 0) && (batch_fill == 0);
+    k_mutex_unlock(&log_lock);
+
+    return empty;
+}
+
+// Get a snapshot of the counters
+void sample_log_stats_get(struct sample_log_stats *stats_out)
+{
+    k_mutex_lock(&log_lock, K_FOREVER);
+    *stats_out = stats;
+    k_mutex_unlock(&log_lock);
+}
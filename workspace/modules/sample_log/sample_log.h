@@ -0,0 +1,52 @@
+#ifndef SAMPLE_LOG_H_
+#define SAMPLE_LOG_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Log counters. Write amplification is written / appended, erase
+// amplification erased / appended.
+struct sample_log_stats {
+    uint32_t appended;      // Bytes handed to sample_log_append()
+    uint32_t written;       // Bytes programmed, with FCB headers and padding
+    uint32_t erased;        // Bytes erased
+    uint32_t entries;       // Flash entries (batches) written
+    uint32_t lost;          // Bytes dropped to make room when full
+    uint32_t drained;       // Bytes handed back by sample_log_drain()
+    uint32_t pending;       // Bytes in flash still to be drained
+    uint32_t write_us;      // Time spent programming and erasing
+    uint32_t read_us;       // Time spent reading
+    uint32_t batch_len;     // Bytes per flash entry
+    uint32_t sector_size;
+    uint32_t sector_count;
+};
+
+// Called for each stored batch, oldest first. Return 0 once the data has
+// been forwarded, or a negative value to stop (the batch is kept).
+typedef int (*sample_log_drain_cb_t)(const uint8_t *data, size_t len, void *user_data);
+
+// Mount the log on the storage partition (existing entries are kept and
+// counted as pending)
+int sample_log_init(void);
+
+// Add a record. Records are never split, so len must fit in one batch; a
+// record that does not fit in what is left of the current batch starts
+// the next one.
+int sample_log_append(const void *data, size_t len);
+
+// Write the staged batch to flash now (e.g. before power down)
+int sample_log_flush(void);
+
+// Hand stored batches to cb until it fails or the log is empty. Staged
+// records are flushed first. Returns the number of bytes drained or a
+// negative error code.
+int sample_log_drain(sample_log_drain_cb_t cb, void *user_data);
+
+// True if nothing is waiting, in flash or staged
+bool sample_log_is_empty(void);
+
+// Get a snapshot of the counters
+void sample_log_stats_get(struct sample_log_stats *stats);
+
+#endif /* SAMPLE_LOG_H_ */
@@ -0,0 +1,328 @@
+#include <errno.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/sys_heap.h>
+
+#include "sprite_cache.h"
+
+// Enable logging at CONFIG_LOG_DEFAULT_LEVEL
+LOG_MODULE_REGISTER(sprite_cache);
+
+// Sprites are stored in LVGL's own RGB565 byte order. The display port swaps
+// each render buffer on its way out (CONFIG_LV_COLOR_16_SWAP), so blitted
+// sprite pixels get swapped exactly once like everything else.
+#define SPRITE_CF LV_COLOR_FORMAT_RGB565
+
+// What a sprite was rendered from. Text sprites (font set) are matched on
+// font, colour and text as well, so they never collide with caller keys or
+// with each other.
+struct sprite_id {
+    uint32_t key;
+    int32_t w;
+    int32_t h;
+    const lv_font_t *font;      // NULL for caller-keyed sprites
+    lv_color_t color;
+    const char *text;
+};
+
+// One cached sprite. The text of a text sprite is copied into the pool
+// right after its pixels.
+struct sprite {
+    lv_draw_buf_t buf;
+    struct sprite_id id;
+    uint32_t alloc_size;
+    uint32_t last_used;
+    uint16_t refs;              // Pinned while non-zero, never evicted
+    bool valid;
+};
+
+// Text sprite being rendered
+struct text_job {
+    const char *text;
+    const lv_font_t *font;
+    lv_color_t color;
+};
+
+//------------------------------------------------------------------------------
+// Forward declarations
+
+static struct sprite *sprite_lookup(const struct sprite_id *id);
+static void sprite_evict(struct sprite *s);
+static struct sprite *sprite_alloc(uint32_t size);
+static const lv_draw_buf_t *sprite_get(const struct sprite_id *id,
+                                       sprite_draw_cb_t draw,
+                                       void *user_data);
+static void text_draw(lv_layer_t *layer, const lv_area_t *area, void *user_data);
+static uint32_t hash_add(uint32_t hash, const void *data, size_t len);
+
+//------------------------------------------------------------------------------
+// Globals
+
+// Pixel memory and the entries pointing into it
+static uint8_t pool_mem[CONFIG_SPRITE_CACHE_SIZE] __aligned(LV_DRAW_BUF_ALIGN);
+static struct sys_heap pool;
+static struct sprite sprites[CONFIG_SPRITE_CACHE_ENTRIES];
+static uint32_t use_count;
+
+// Off-screen canvas used to render misses (on a screen that is never loaded)
+static lv_obj_t *canvas;
+static lv_color_t bg;
+
+// Counters
+static struct sprite_cache_stats counters;
+
+//------------------------------------------------------------------------------
+// Private functions
+
+// Find a cached sprite rendered from exactly id and mark it as recently
+// used. The key only narrows the search, the rest must match too.
+static struct sprite *sprite_lookup(const struct sprite_id *id)
+{
+    const struct sprite_id *s_id;
+
+    for (int i = 0; i < CONFIG_SPRITE_CACHE_ENTRIES; i++) {
+        s_id = &sprites[i].id;
+        if (!sprites[i].valid || (s_id->key != id->key) ||
+            (s_id->w != id->w) || (s_id->h != id->h) ||
+            (s_id->font != id->font)) {
+            continue;
+        }
+        if ((id->font != NULL) &&
+            (!lv_color_eq(s_id->color, id->color) ||
+             (strcmp(s_id->text, id->text) != 0))) {
+            continue;
+        }
+
+        sprites[i].last_used = ++use_count;
+        return &sprites[i];
+    }
+
+    return NULL;
+}
+
+// Release a sprite's pixels. LVGL may have cached a decoded copy keyed by
+// the buffer address, which the next sprite in this slot would inherit.
+static void sprite_evict(struct sprite *s)
+{
+    lv_image_cache_drop(&s->buf);
+    sys_heap_free(&pool, s->buf.data);
+    counters.bytes_used -= s->alloc_size;
+    counters.entries--;
+    counters.evictions++;
+    s->valid = false;
+}
+
+// Get a free entry with size bytes of pool memory, evicting the least
+// recently used unpinned sprites until both are available
+static struct sprite *sprite_alloc(uint32_t size)
+{
+    struct sprite *free_entry;
+    struct sprite *lru;
+    void *data;
+
+    if (size > sizeof(pool_mem)) {
+        return NULL;
+    }
+
+    while (1) {
+        free_entry = NULL;
+        lru = NULL;
+        for (int i = 0; i < CONFIG_SPRITE_CACHE_ENTRIES; i++) {
+            if (!sprites[i].valid) {
+                free_entry = (free_entry == NULL) ? &sprites[i] : free_entry;
+            } else if ((sprites[i].refs == 0) &&
+                       ((lru == NULL) || (sprites[i].last_used < lru->last_used))) {
+                lru = &sprites[i];
+            }
+        }
+
+        if (free_entry != NULL) {
+            data = sys_heap_aligned_alloc(&pool, LV_DRAW_BUF_ALIGN, size);
+            if (data != NULL) {
+                free_entry->buf.data = data;
+                free_entry->alloc_size = size;
+                return free_entry;
+            }
+        }
+
+        // Out of entries or memory: make room (fails if everything is pinned)
+        if (lru == NULL) {
+            return NULL;
+        }
+        sprite_evict(lru);
+    }
+}
+
+// Get the sprite for id, pinned, rendering it with draw on a miss
+static const lv_draw_buf_t *sprite_get(const struct sprite_id *id,
+                                       sprite_draw_cb_t draw,
+                                       void *user_data)
+{
+    struct sprite *s;
+    lv_layer_t layer;
+    lv_area_t area = { 0, 0, id->w - 1, id->h - 1 };
+    size_t text_len = 0;
+    char *text_copy;
+    uint32_t stride;
+    uint32_t size;
+    uint32_t start;
+
+    if ((id->w <= 0) || (id->h <= 0)) {
+        return NULL;
+    }
+
+    s = sprite_lookup(id);
+    if (s != NULL) {
+        s->refs++;
+        counters.hits++;
+        return &s->buf;
+    }
+
+    // Text sprites keep a copy of their text after the pixels
+    stride = lv_draw_buf_width_to_stride(id->w, SPRITE_CF);
+    size = stride * id->h;
+    if (id->font != NULL) {
+        text_len = strlen(id->text) + 1;
+    }
+    s = sprite_alloc(size + text_len);
+    if (s == NULL) {
+        LOG_WRN("Sprite %08x (%dx%d) does not fit the cache", id->key, id->w, id->h);
+        counters.failures++;
+        return NULL;
+    }
+
+    // Render once: background, then the caller's drawing
+    start = k_cycle_get_32();
+    lv_draw_buf_init(&s->buf, id->w, id->h, SPRITE_CF, stride, s->buf.data, size);
+    lv_canvas_set_draw_buf(canvas, &s->buf);
+    lv_canvas_fill_bg(canvas, bg, LV_OPA_COVER);
+    lv_canvas_init_layer(canvas, &layer);
+    draw(&layer, &area, user_data);
+    lv_canvas_finish_layer(canvas, &layer);
+    counters.render_us += k_cyc_to_us_floor64(k_cycle_get_32() - start);
+
+    s->id = *id;
+    if (text_len > 0) {
+        text_copy = (char *)s->buf.data + size;
+        memcpy(text_copy, id->text, text_len);
+        s->id.text = text_copy;
+    }
+    s->last_used = ++use_count;
+    s->refs = 1;
+    s->valid = true;
+    counters.misses++;
+    counters.entries++;
+    counters.bytes_used += s->alloc_size;
+    if (counters.bytes_used > counters.bytes_peak) {
+        counters.bytes_peak = counters.bytes_used;
+    }
+
+    return &s->buf;
+}
+
+// Draw callback for text sprites
+static void text_draw(lv_layer_t *layer, const lv_area_t *area, void *user_data)
+{
+    const struct text_job *job = user_data;
+    lv_draw_label_dsc_t dsc;
+
+    lv_draw_label_dsc_init(&dsc);
+    dsc.text = job->text;
+    dsc.font = job->font;
+    dsc.color = job->color;
+    lv_draw_label(layer, &dsc, area);
+}
+
+// FNV-1a
+static uint32_t hash_add(uint32_t hash, const void *data, size_t len)
+{
+    const uint8_t *p = data;
+
+    for (size_t i = 0; i < len; i++) {
+        hash = (hash ^ p[i]) * 16777619U;
+    }
+
+    return hash;
+}
+
+//------------------------------------------------------------------------------
+// Public functions (API)
+
+// Set up the cache (call from the LVGL thread)
+int sprite_cache_init(lv_color_t bg_color)
+{
+    sys_heap_init(&pool, pool_mem, sizeof(pool_mem));
+    memset(sprites, 0, sizeof(sprites));
+    memset(&counters, 0, sizeof(counters));
+    counters.bytes_total = sizeof(pool_mem);
+    bg = bg_color;
+
+    canvas = lv_canvas_create(NULL);
+    if (canvas == NULL) {
+        LOG_ERR("Could not create the sprite canvas");
+        return -ENOMEM;
+    }
+
+    return 0;
+}
+
+// Get the sprite for key, rendering it on a miss
+const lv_draw_buf_t *sprite_cache_get(uint32_t key,
+                                      int32_t w,
+                                      int32_t h,
+                                      sprite_draw_cb_t draw,
+                                      void *user_data)
+{
+    struct sprite_id id = { .key = key, .w = w, .h = h };
+
+    return sprite_get(&id, draw, user_data);
+}
+
+// Get the sprite for a run of text in one font and colour
+const lv_draw_buf_t *sprite_cache_text(const char *text,
+                                       const lv_font_t *font,
+                                       lv_color_t color)
+{
+    struct text_job job = { .text = text, .font = font, .color = color };
+    struct sprite_id id = { .font = font, .color = color, .text = text };
+    lv_point_t size;
+
+    if ((text == NULL) || (font == NULL)) {
+        return NULL;
+    }
+
+    id.key = 2166136261U;
+    id.key = hash_add(id.key, &font, sizeof(font));
+    id.key = hash_add(id.key, &color, sizeof(color));
+    id.key = hash_add(id.key, text, strlen(text));
+
+    lv_text_get_size(&size, text, font, 0, 0, LV_COORD_MAX, LV_TEXT_FLAG_NONE);
+    id.w = size.x;
+    id.h = size.y;
+
+    return sprite_get(&id, text_draw, &job);
+}
+
+// Unpin a sprite returned by sprite_cache_get() or sprite_cache_text()
+void sprite_cache_release(const lv_draw_buf_t *sprite)
+{
+    if (sprite == NULL) {
+        return;
+    }
+
+    for (int i = 0; i < CONFIG_SPRITE_CACHE_ENTRIES; i++) {
+        if (sprites[i].valid && (&sprites[i].buf == sprite)) {
+            if (sprites[i].refs > 0) {
+                sprites[i].refs--;
+            }
+            return;
+        }
+    }
+}
+
+// Get a snapshot of the cache counters
+void sprite_cache_stats_get(struct sprite_cache_stats *stats)
+{
+    *stats = counters;
+}
@@ -0,0 +1,51 @@
+#ifndef SPRITE_CACHE_H_
+#define SPRITE_CACHE_H_
+
+#include <stdint.h>
+#include <lvgl.h>
+
+// Draws a sprite into the canvas layer, area covers the whole sprite
+typedef void (*sprite_draw_cb_t)(lv_layer_t *layer,
+                                 const lv_area_t *area,
+                                 void *user_data);
+
+// Cache counters
+struct sprite_cache_stats {
+    uint32_t hits;
+    uint32_t misses;        // Sprites rendered
+    uint32_t evictions;
+    uint32_t failures;      // Sprites too large for the cache
+    uint32_t entries;       // Sprites cached now
+    uint32_t bytes_used;    // Pixel memory in use
+    uint32_t bytes_peak;
+    uint32_t bytes_total;
+    uint64_t render_us;     // Time spent rendering misses
+};
+
+// Set up the cache. Sprites are opaque: they are drawn over bg_color, which
+// should match what they are shown on. Call from the LVGL thread.
+int sprite_cache_init(lv_color_t bg_color);
+
+// Get the sprite for key and size, rendering it with draw on a miss. The
+// result can be passed to lv_image_set_src() and stays pinned (never
+// evicted) until sprite_cache_release(), so release it once no image shows
+// it any more. Returns NULL if it does not fit next to the pinned sprites.
+const lv_draw_buf_t *sprite_cache_get(uint32_t key,
+                                      int32_t w,
+                                      int32_t h,
+                                      sprite_draw_cb_t draw,
+                                      void *user_data);
+
+// Get the sprite for a run of text in one font and colour, pinned like
+// sprite_cache_get(). Text sprites never match caller keys.
+const lv_draw_buf_t *sprite_cache_text(const char *text,
+                                       const lv_font_t *font,
+                                       lv_color_t color);
+
+// Unpin a sprite (once per get), letting it be evicted again. NULL is ignored.
+void sprite_cache_release(const lv_draw_buf_t *sprite);
+
+// Get a snapshot of the cache counters
+void sprite_cache_stats_get(struct sprite_cache_stats *stats);
+
+#endif /* SPRITE_CACHE_H_ */
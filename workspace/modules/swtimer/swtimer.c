@@ -0,0 +1,362 @@
+#include <errno.h>
+#include <zephyr/kernel.h>
+#include <zephyr/drivers/counter.h>
+#include <zephyr/logging/log.h>
+
+#include "swtimer.h"
+
+// Enable logging at CONFIG_LOG_DEFAULT_LEVEL
+LOG_MODULE_REGISTER(swtimer);
+
+// Shortest time (us) from now an alarm is programmed for. Anything due
+// sooner fires a little late instead of being missed by the hardware.
+#define SWTIMER_MIN_DELTA_US 10
+
+//------------------------------------------------------------------------------
+// Forward declarations
+
+static uint64_t now_locked(void);
+static void heap_swap(int a, int b);
+static void heap_sift_up(int idx);
+static void heap_sift_down(int idx);
+static int heap_insert(struct swtimer *timer);
+static void heap_remove(struct swtimer *timer);
+static void alarm_arm(void);
+static void alarm_handler(const struct device *dev,
+                          uint8_t chan_id,
+                          uint32_t ticks,
+                          void *user_data);
+
+//------------------------------------------------------------------------------
+// Globals
+
+// Counter and channel owned by the service
+static const struct device *counter_dev;
+static uint8_t alarm_chan;
+
+// Counter wrap handling: ticks = base + raw counter value
+static uint64_t wrap_ticks;
+static uint64_t base;
+static uint32_t last_raw;
+
+// Alarm limits (ticks)
+static uint32_t guard_ticks;
+static uint32_t min_ticks;
+
+// Min-heap of running timers ordered by expiry
+static struct swtimer *heap[CONFIG_SWTIMER_MAX_TIMERS];
+static int heap_len;
+
+static struct swtimer_stats stats;
+static struct k_spinlock lock;
+
+//------------------------------------------------------------------------------
+// Private functions
+
+// Extend the counter to 64 bits (the guard alarm guarantees this runs at
+// least twice per counter wrap)
+static uint64_t now_locked(void)
+{
+    uint32_t raw;
+
+    counter_get_value(counter_dev, &raw);
+    if (raw < last_raw) {
+        base += wrap_ticks;
+    }
+    last_raw = raw;
+
+    return base + raw;
+}
+
+// Swap two heap entries and keep their back-references up to date
+static void heap_swap(int a, int b)
+{
+    struct swtimer *tmp = heap[a];
+
+    heap[a] = heap[b];
+    heap[b] = tmp;
+    heap[a]->heap_idx = a;
+    heap[b]->heap_idx = b;
+}
+
+// Move an entry towards the root while it expires before its parent
+static void heap_sift_up(int idx)
+{
+    while (idx > 0) {
+        int parent = (idx - 1) / 2;
+
+        if (heap[parent]->expiry <= heap[idx]->expiry) {
+            break;
+        }
+        heap_swap(idx, parent);
+        idx = parent;
+    }
+}
+
+// Move an entry towards the leaves while a child expires before it
+static void heap_sift_down(int idx)
+{
+    while (1) {
+        int left = 2 * idx + 1;
+        int right = left + 1;
+        int first = idx;
+
+        if ((left < heap_len) && (heap[left]->expiry < heap[first]->expiry)) {
+            first = left;
+        }
+        if ((right < heap_len) && (heap[right]->expiry < heap[first]->expiry)) {
+            first = right;
+        }
+        if (first == idx) {
+            break;
+        }
+        heap_swap(idx, first);
+        idx = first;
+    }
+}
+
+// Add a timer to the heap
+static int heap_insert(struct swtimer *timer)
+{
+    if (heap_len >= CONFIG_SWTIMER_MAX_TIMERS) {
+        return -ENOMEM;
+    }
+
+    heap[heap_len] = timer;
+    timer->heap_idx = heap_len;
+    heap_len++;
+    heap_sift_up(timer->heap_idx);
+
+    return 0;
+}
+
+// Remove a timer from anywhere in the heap
+static void heap_remove(struct swtimer *timer)
+{
+    int idx = timer->heap_idx;
+    struct swtimer *moved;
+
+    // Fill the hole with the last entry and restore the heap order
+    heap_len--;
+    if (idx != heap_len) {
+        heap_swap(idx, heap_len);
+        moved = heap[idx];
+        heap_sift_up(idx);
+        heap_sift_down(moved->heap_idx);
+    }
+    timer->heap_idx = -1;
+}
+
+// Program the hardware alarm for the earliest timer (or the wrap guard)
+static void alarm_arm(void)
+{
+    struct counter_alarm_cfg cfg = {
+        .callback = alarm_handler,
+        .flags = COUNTER_ALARM_CFG_ABSOLUTE,
+    };
+    uint64_t now;
+    uint64_t target;
+    int ret;
+
+    counter_cancel_channel_alarm(counter_dev, alarm_chan);
+
+    do {
+        now = now_locked();
+
+        // Never sleep longer than half a wrap so now_locked() sees every wrap
+        target = now + guard_ticks;
+        if ((heap_len > 0) && (heap[0]->expiry < target)) {
+            target = heap[0]->expiry;
+        }
+        if (target < now + min_ticks) {
+            target = now + min_ticks;
+        }
+
+        // -ETIME means we were held up and the target already passed
+        cfg.ticks = (uint32_t)(target % wrap_ticks);
+        ret = counter_set_channel_alarm(counter_dev, alarm_chan, &cfg);
+    } while (ret == -ETIME);
+
+    if (ret < 0) {
+        LOG_ERR("Error (%d): could not set alarm", ret);
+    }
+}
+
+// Counter alarm callback (ISR): run every expired timer, then re-arm
+static void alarm_handler(const struct device *dev,
+                          uint8_t chan_id,
+                          uint32_t ticks,
+                          void *user_data)
+{
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    struct swtimer *timer;
+    uint64_t now;
+    uint64_t late;
+
+    stats.alarms++;
+
+    while (heap_len > 0) {
+        now = now_locked();
+        timer = heap[0];
+        if (timer->expiry > now) {
+            break;
+        }
+
+        // Track lateness against the ideal (absolute) expiry
+        late = now - timer->expiry;
+        if (late > stats.max_late_ticks) {
+            stats.max_late_ticks = (uint32_t)MIN(late, UINT32_MAX);
+        }
+        stats.fired++;
+
+        // Re-arm periodic timers from the ideal expiry, not from now, so
+        // interrupt latency never accumulates into drift
+        heap_remove(timer);
+        if (timer->period) {
+            timer->expiry += timer->period;
+            heap_insert(timer);
+        }
+
+        // Run the callback unlocked so it may start or stop timers
+        k_spin_unlock(&lock, key);
+        timer->handler(timer, timer->user_data);
+        key = k_spin_lock(&lock);
+    }
+
+    alarm_arm();
+
+    k_spin_unlock(&lock, key);
+}
+
+//------------------------------------------------------------------------------
+// Public functions (API)
+
+// Take over a counter alarm channel
+int swtimer_service_init(const struct device *counter, uint8_t chan_id)
+{
+    k_spinlock_key_t key;
+    int ret;
+
+    // Check that the counter is ready and usable
+    if (!device_is_ready(counter)) {
+        LOG_ERR("Counter device is not ready");
+        return -ENODEV;
+    }
+    if (!counter_is_counting_up(counter)) {
+        LOG_ERR("Counter must count up");
+        return -ENOTSUP;
+    }
+    if (chan_id >= counter_get_num_of_channels(counter)) {
+        LOG_ERR("Invalid alarm channel: %u", chan_id);
+        return -EINVAL;
+    }
+
+    // Start the counter (it keeps running for the lifetime of the service)
+    ret = counter_start(counter);
+    if (ret < 0) {
+        LOG_ERR("Error (%d): could not start counter", ret);
+        return ret;
+    }
+
+    key = k_spin_lock(&lock);
+
+    counter_dev = counter;
+    alarm_chan = chan_id;
+    wrap_ticks = (uint64_t)counter_get_top_value(counter) + 1;
+    guard_ticks = (uint32_t)(wrap_ticks / 2);
+    min_ticks = MAX(counter_us_to_ticks(counter, SWTIMER_MIN_DELTA_US), 1);
+    base = 0;
+    counter_get_value(counter, &last_raw);
+    heap_len = 0;
+
+    // Start the wrap guard right away
+    alarm_arm();
+
+    k_spin_unlock(&lock, key);
+
+    LOG_DBG("Service running on channel %u, %u Hz",
+            chan_id,
+            counter_get_frequency(counter));
+
+    return 0;
+}
+
+// Initialize a timer before first use
+void swtimer_init(struct swtimer *timer,
+                  swtimer_handler_t handler,
+                  void *user_data)
+{
+    timer->expiry = 0;
+    timer->period = 0;
+    timer->handler = handler;
+    timer->user_data = user_data;
+    timer->heap_idx = -1;
+}
+
+// (Re)start a timer
+int swtimer_start(struct swtimer *timer, uint32_t delay_us, uint32_t period_us)
+{
+    k_spinlock_key_t key;
+    int ret;
+
+    if (counter_dev == NULL) {
+        return -ENODEV;
+    }
+
+    key = k_spin_lock(&lock);
+
+    // Restarting a running timer moves it
+    if (timer->heap_idx >= 0) {
+        heap_remove(timer);
+    }
+
+    timer->expiry = now_locked() + counter_us_to_ticks(counter_dev, delay_us);
+    timer->period = counter_us_to_ticks(counter_dev, period_us);
+    if ((period_us > 0) && (timer->period == 0)) {
+        timer->period = 1;
+    }
+
+    // Only touch the hardware if this timer is now the earliest
+    ret = heap_insert(timer);
+    if ((ret == 0) && (timer->heap_idx == 0)) {
+        alarm_arm();
+    }
+
+    k_spin_unlock(&lock, key);
+
+    return ret;
+}
+
+// Stop a timer
+void swtimer_stop(struct swtimer *timer)
+{
+    k_spinlock_key_t key = k_spin_lock(&lock);
+
+    // The hardware alarm is left alone: an early wakeup finds nothing to do
+    if (timer->heap_idx >= 0) {
+        heap_remove(timer);
+    }
+
+    k_spin_unlock(&lock, key);
+}
+
+// Current time in extended counter ticks
+uint64_t swtimer_now(void)
+{
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    uint64_t now = now_locked();
+
+    k_spin_unlock(&lock, key);
+
+    return now;
+}
+
+// Get a snapshot of the service statistics
+void swtimer_stats_get(struct swtimer_stats *stats_out)
+{
+    k_spinlock_key_t key = k_spin_lock(&lock);
+
+    *stats_out = stats;
+
+    k_spin_unlock(&lock, key);
+}
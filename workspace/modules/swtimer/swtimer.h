@@ -0,0 +1,49 @@
+#ifndef SWTIMER_H_
+#define SWTIMER_H_
+
+#include <stdint.h>
+#include <zephyr/device.h>
+
+struct swtimer;
+
+// Timer callback (runs in the counter's interrupt context)
+typedef void (*swtimer_handler_t)(struct swtimer *timer, void *user_data);
+
+// Software timer (treat the fields as private)
+struct swtimer {
+    uint64_t expiry;            // Absolute expiry (extended counter ticks)
+    uint32_t period;            // Reload in ticks, 0 for one-shot
+    swtimer_handler_t handler;
+    void *user_data;
+    int16_t heap_idx;           // Position in the heap, -1 when stopped
+};
+
+// Service statistics
+struct swtimer_stats {
+    uint32_t fired;             // Callbacks run
+    uint32_t alarms;            // Hardware alarm interrupts taken
+    uint32_t max_late_ticks;    // Worst callback lateness seen
+};
+
+// Take over a counter alarm channel (starts the counter if needed)
+int swtimer_service_init(const struct device *counter, uint8_t chan_id);
+
+// Initialize a timer before first use
+void swtimer_init(struct swtimer *timer,
+                  swtimer_handler_t handler,
+                  void *user_data);
+
+// (Re)start a timer: first expiry after delay_us, then every period_us
+// (period_us of 0 makes it one-shot)
+int swtimer_start(struct swtimer *timer, uint32_t delay_us, uint32_t period_us);
+
+// Stop a timer (no effect if it is not running)
+void swtimer_stop(struct swtimer *timer);
+
+// Current time in extended (64-bit) counter ticks
+uint64_t swtimer_now(void);
+
+// Get a snapshot of the service statistics
+void swtimer_stats_get(struct swtimer_stats *stats);
+
+#endif /* SWTIMER_H_ */
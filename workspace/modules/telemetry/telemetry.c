@@ -0,0 +1,455 @@
+#include <errno.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/net/http/client.h>
+
+#ifdef CONFIG_TELEMETRY_FORMAT_CBOR
+#include <zcbor_encode.h>
+#endif
+
+#include "http_pool.h"
+#include "telemetry.h"
+#ifdef CONFIG_TELEMETRY_STORE
+#include "sample_log.h"
+#endif
+
+// Enable logging at CONFIG_LOG_DEFAULT_LEVEL
+LOG_MODULE_REGISTER(telemetry);
+
+// Batch payload: {"t0": <uptime ms>, "s": [[<ms after t0>, <channel>, <value>], ...]}
+#ifdef CONFIG_TELEMETRY_FORMAT_CBOR
+#define CONTENT_TYPE "application/cbor"
+#else
+#define CONTENT_TYPE "application/json"
+#endif
+
+// Upload settings
+#define UPLOAD_TIMEOUT_MS 5000
+#define RESPONSE_BUF_LEN 256
+
+// One buffered sample
+struct sample {
+    uint32_t ts_ms;
+    int32_t value;
+    uint8_t channel;
+};
+
+//------------------------------------------------------------------------------
+// Forward declarations
+
+static size_t ring_peek(struct sample *out, size_t max, uint32_t *first_seq);
+static void ring_consume(uint32_t end_seq);
+static int encode(const struct sample *s, size_t n, size_t *len);
+static void response_cb(struct http_response *rsp,
+                        enum http_final_call final_data,
+                        void *user_data);
+static int upload(size_t len);
+static int send_batch(size_t n);
+static int send_ring(void);
+#ifdef CONFIG_TELEMETRY_STORE
+static void store_ring(void);
+static int drain_cb(const uint8_t *data, size_t len, void *user_data);
+#endif
+static void telemetry_thread_start(void *arg1, void *arg2, void *arg3);
+
+//------------------------------------------------------------------------------
+// Globals
+
+// Samples waiting to go out. tail_seq numbers the oldest one, so a batch
+// can be consumed after upload even if newer samples pushed some out.
+static struct sample ring[CONFIG_TELEMETRY_BUFFER_SAMPLES];
+static size_t ring_tail;
+static size_t ring_count;
+static uint32_t tail_seq;
+static struct k_spinlock ring_lock;
+
+// Whether the last upload went through (under ring_lock). Only then does a
+// full batch wake the uploader early.
+static bool upload_ok = true;
+
+// Uploader thread and the buffers only it touches
+K_THREAD_STACK_DEFINE(telemetry_stack, CONFIG_TELEMETRY_THREAD_STACK_SIZE);
+static struct k_thread telemetry_thread;
+static K_SEM_DEFINE(wake_sem, 0, 1);
+static const struct telemetry_config *config;
+static struct sample batch[CONFIG_TELEMETRY_BATCH_SAMPLES];
+static uint8_t payload[CONFIG_TELEMETRY_PAYLOAD_SIZE];
+static uint8_t response_buf[RESPONSE_BUF_LEN];
+
+// Counters (updated under ring_lock, producers bump samples and dropped)
+static struct telemetry_stats stats;
+
+//------------------------------------------------------------------------------
+// Private functions
+
+// Copy out up to max of the oldest samples without removing them
+static size_t ring_peek(struct sample *out, size_t max, uint32_t *first_seq)
+{
+    k_spinlock_key_t key = k_spin_lock(&ring_lock);
+    size_t n = MIN(max, ring_count);
+
+    for (size_t i = 0; i < n; i++) {
+        out[i] = ring[(ring_tail + i) % CONFIG_TELEMETRY_BUFFER_SAMPLES];
+    }
+    *first_seq = tail_seq;
+    k_spin_unlock(&ring_lock, key);
+
+    return n;
+}
+
+// Remove every sample numbered below end_seq (some may be gone already)
+static void ring_consume(uint32_t end_seq)
+{
+    k_spinlock_key_t key = k_spin_lock(&ring_lock);
+
+    while ((ring_count > 0) && ((int32_t)(end_seq - tail_seq) > 0)) {
+        ring_tail = (ring_tail + 1) % CONFIG_TELEMETRY_BUFFER_SAMPLES;
+        ring_count--;
+        tail_seq++;
+    }
+    k_spin_unlock(&ring_lock, key);
+}
+
+// Encode n samples into the payload buffer. Timestamps are sent relative
+// to the first sample, which keeps most of them to one or two bytes in CBOR.
+#ifdef CONFIG_TELEMETRY_FORMAT_CBOR
+static int encode(const struct sample *s, size_t n, size_t *len)
+{
+    ZCBOR_STATE_E(zs, 3, payload, sizeof(payload), 1);
+    bool ok;
+
+    ok = zcbor_map_start_encode(zs, 2) &&
+         zcbor_tstr_put_lit(zs, "t0") &&
+         zcbor_uint32_put(zs, s[0].ts_ms) &&
+         zcbor_tstr_put_lit(zs, "s") &&
+         zcbor_list_start_encode(zs, n);
+    for (size_t i = 0; ok && (i < n); i++) {
+        ok = zcbor_list_start_encode(zs, 3) &&
+             zcbor_uint32_put(zs, s[i].ts_ms - s[0].ts_ms) &&
+             zcbor_uint32_put(zs, s[i].channel) &&
+             zcbor_int32_put(zs, s[i].value) &&
+             zcbor_list_end_encode(zs, 3);
+    }
+    ok = ok && zcbor_list_end_encode(zs, n) && zcbor_map_end_encode(zs, 2);
+    if (!ok) {
+        return -ENOMEM;
+    }
+    *len = zs->payload - payload;
+
+    return 0;
+}
+#else
+static int encode(const struct sample *s, size_t n, size_t *len)
+{
+    size_t pos;
+    int ret;
+
+    ret = snprintk((char *)payload, sizeof(payload), "{\"t0\":%u,\"s\":[", s[0].ts_ms);
+    pos = ret;
+    for (size_t i = 0; (i < n) && (pos < sizeof(payload)); i++) {
+        ret = snprintk((char *)payload + pos,
+                       sizeof(payload) - pos,
+                       "%s[%u,%u,%d]",
+                       (i > 0) ? "," : "",
+                       s[i].ts_ms - s[0].ts_ms,
+                       s[i].channel,
+                       s[i].value);
+        pos += ret;
+    }
+    if (pos < sizeof(payload)) {
+        pos += snprintk((char *)payload + pos, sizeof(payload) - pos, "]}");
+    }
+
+    // snprintk() reports what it would have written, so this catches any
+    // truncation above
+    if (pos >= sizeof(payload)) {
+        return -ENOMEM;
+    }
+    *len = pos;
+
+    return 0;
+}
+#endif
+
+// Nothing to read from the reply, only its status matters
+static void response_cb(struct http_response *rsp,
+                        enum http_final_call final_data,
+                        void *user_data)
+{
+    ARG_UNUSED(rsp);
+    ARG_UNUSED(final_data);
+    ARG_UNUSED(user_data);
+}
+
+// POST the encoded batch, succeeds on any 2xx reply
+static int upload(size_t len)
+{
+    struct http_request req;
+    uint16_t status;
+    int ret;
+
+    memset(&req, 0, sizeof(req));
+    req.method = HTTP_POST;
+    req.url = config->path;
+    req.host = config->host;
+    req.protocol = "HTTP/1.1";
+    req.content_type_value = CONTENT_TYPE;
+    req.payload = (const char *)payload;
+    req.payload_len = len;
+    req.response = response_cb;
+    req.recv_buf = response_buf;
+    req.recv_buf_len = sizeof(response_buf);
+
+    ret = http_pool_request(config->host, config->port, &req, UPLOAD_TIMEOUT_MS, NULL);
+    if (ret < 0) {
+        LOG_ERR("Error (%d): upload failed", ret);
+        return ret;
+    }
+
+    status = req.internal.response.http_status_code;
+    if ((status < 200) || (status >= 300)) {
+        LOG_ERR("Error: server replied %u", status);
+        return -EIO;
+    }
+
+    return 0;
+}
+
+// Upload the first n samples in batch[], or as many of them as fit in one
+// payload. Returns the number sent, -ENOMEM if not even one sample fits,
+// or the upload error.
+static int send_batch(size_t n)
+{
+    size_t len;
+    int64_t start;
+    k_spinlock_key_t key;
+    int ret;
+
+    // Send what fits, the rest goes in the next request
+    while (((ret = encode(batch, n, &len)) == -ENOMEM) && (n > 1)) {
+        n /= 2;
+    }
+    if (ret < 0) {
+        LOG_ERR("Error (%d): could not encode batch", ret);
+        return ret;
+    }
+
+    start = k_uptime_get();
+    ret = upload(len);
+    key = k_spin_lock(&ring_lock);
+    if (ret < 0) {
+        stats.failures++;
+    } else {
+        stats.sent += n;
+        stats.batches++;
+        stats.payload_bytes += len;
+        stats.last_batch_bytes = len;
+        stats.last_upload_ms = (uint32_t)(k_uptime_get() - start);
+    }
+    k_spin_unlock(&ring_lock, key);
+
+    return (ret < 0) ? ret : (int)n;
+}
+
+// Send everything in the ring. On failure the rest stays there.
+static int send_ring(void)
+{
+    uint32_t first_seq;
+    size_t n;
+    int ret;
+
+    while (1) {
+        n = ring_peek(batch, ARRAY_SIZE(batch), &first_seq);
+        if (n == 0) {
+            return 0;
+        }
+
+        ret = send_batch(n);
+        if (ret == -ENOMEM) {
+            ring_consume(first_seq + 1);
+            continue;
+        }
+        if (ret < 0) {
+            return ret;
+        }
+        ring_consume(first_seq + ret);
+    }
+}
+
+#ifdef CONFIG_TELEMETRY_STORE
+// Move the ring into the flash log, where it survives a long outage. The
+// log writes whole batches only, so the last few samples wait in its RAM
+// staging buffer until more arrive.
+static void store_ring(void)
+{
+    uint32_t first_seq;
+    size_t n;
+    size_t i;
+    k_spinlock_key_t key;
+    int ret = 0;
+
+    while (ret == 0) {
+        n = ring_peek(batch, ARRAY_SIZE(batch), &first_seq);
+        if (n == 0) {
+            break;
+        }
+
+        for (i = 0; i < n; i++) {
+            ret = sample_log_append(&batch[i], sizeof(batch[i]));
+            if (ret < 0) {
+                LOG_ERR("Error (%d): could not store samples", ret);
+                break;
+            }
+        }
+
+        ring_consume(first_seq + i);
+        key = k_spin_lock(&ring_lock);
+        stats.stored += i;
+        k_spin_unlock(&ring_lock, key);
+    }
+}
+
+// Upload one flash batch. It is only released once all of it has gone out,
+// so a failure part way through sends the first part again later.
+static int drain_cb(const uint8_t *data, size_t len, void *user_data)
+{
+    size_t total = len / sizeof(struct sample);
+    size_t done = 0;
+    size_t n;
+    int ret;
+
+    ARG_UNUSED(user_data);
+
+    while (done < total) {
+        n = MIN(total - done, ARRAY_SIZE(batch));
+        memcpy(batch, data + (done * sizeof(struct sample)), n * sizeof(struct sample));
+
+        ret = send_batch(n);
+        if (ret == -ENOMEM) {
+
+            // Skip a sample that cannot be encoded, as send_ring() does
+            ret = 1;
+        } else if (ret < 0) {
+            return ret;
+        }
+        done += ret;
+    }
+
+    return 0;
+}
+#endif
+
+// Uploader: wake on the interval (or a full batch), send everything waiting
+static void telemetry_thread_start(void *arg1, void *arg2, void *arg3)
+{
+    k_spinlock_key_t key;
+    int ret;
+
+    while (1) {
+        k_sem_take(&wake_sem, K_MSEC(CONFIG_TELEMETRY_INTERVAL_MS));
+
+        ret = send_ring();
+
+#ifdef CONFIG_TELEMETRY_STORE
+        // Offline: park the samples in flash. Back online: catch up on
+        // what was parked.
+        if (ret < 0) {
+            store_ring();
+        } else if (!sample_log_is_empty()) {
+            ret = sample_log_drain(drain_cb, NULL);
+            if (ret > 0) {
+                LOG_INF("Drained %d bytes from flash", ret);
+            }
+        }
+#endif
+
+        // After a failure the samples stay and only the interval retries:
+        // a full ring would otherwise wake us at the sample rate while the
+        // link is down
+        key = k_spin_lock(&ring_lock);
+        upload_ok = (ret >= 0);
+        k_spin_unlock(&ring_lock, key);
+    }
+}
+
+//------------------------------------------------------------------------------
+// Public functions (API)
+
+// Start the uploader thread
+int telemetry_init(const struct telemetry_config *cfg)
+{
+    if ((cfg == NULL) || (cfg->host == NULL) || (cfg->port == NULL) || (cfg->path == NULL)) {
+        return -EINVAL;
+    }
+    config = cfg;
+
+#ifdef CONFIG_TELEMETRY_STORE
+    int ret = sample_log_init();
+
+    if (ret < 0) {
+        LOG_ERR("Error (%d): could not open flash log", ret);
+        return ret;
+    }
+#endif
+
+    k_thread_create(&telemetry_thread,
+                    telemetry_stack,
+                    K_THREAD_STACK_SIZEOF(telemetry_stack),
+                    telemetry_thread_start,
+                    NULL,
+                    NULL,
+                    NULL,
+                    CONFIG_TELEMETRY_THREAD_PRIORITY,
+                    0,
+                    K_NO_WAIT);
+    k_thread_name_set(&telemetry_thread, "telemetry");
+
+    return 0;
+}
+
+// Record a sample, dropping the oldest if the buffer is full
+void telemetry_add(uint8_t channel, int32_t value_milli)
+{
+    k_spinlock_key_t key = k_spin_lock(&ring_lock);
+    struct sample *s;
+    size_t waiting;
+    bool early;
+
+    if (ring_count == CONFIG_TELEMETRY_BUFFER_SAMPLES) {
+        ring_tail = (ring_tail + 1) % CONFIG_TELEMETRY_BUFFER_SAMPLES;
+        ring_count--;
+        tail_seq++;
+        stats.dropped++;
+    }
+
+    s = &ring[(ring_tail + ring_count) % CONFIG_TELEMETRY_BUFFER_SAMPLES];
+    s->ts_ms = k_uptime_get_32();
+    s->channel = channel;
+    s->value = value_milli;
+    ring_count++;
+    stats.samples++;
+    waiting = ring_count;
+    early = upload_ok;
+    k_spin_unlock(&ring_lock, key);
+
+    // A full batch goes out straight away, unless the last upload failed
+    if (early && (waiting >= CONFIG_TELEMETRY_BATCH_SAMPLES)) {
+        k_sem_give(&wake_sem);
+    }
+}
+
+// Upload what is waiting now
+void telemetry_flush(void)
+{
+    k_sem_give(&wake_sem);
+}
+
+// Get a snapshot of the counters
+void telemetry_stats_get(struct telemetry_stats *stats_out)
+{
+    k_spinlock_key_t key = k_spin_lock(&ring_lock);
+
+    *stats_out = stats;
+    k_spin_unlock(&ring_lock, key);
+}
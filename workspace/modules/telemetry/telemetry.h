@@ -0,0 +1,39 @@
+#ifndef TELEMETRY_H_
+#define TELEMETRY_H_
+
+#include <stdint.h>
+
+// Where batches are sent
+struct telemetry_config {
+    const char *host;
+    const char *port;
+    const char *path;
+};
+
+// Uploader counters
+struct telemetry_stats {
+    uint32_t samples;       // Samples added
+    uint32_t dropped;       // Samples overwritten before they were sent
+    uint32_t sent;          // Samples uploaded
+    uint32_t batches;       // Successful uploads
+    uint32_t failures;      // Failed uploads (the batch is kept and retried)
+    uint32_t stored;        // Samples moved to the flash log while offline
+    uint32_t payload_bytes; // Encoded bytes uploaded
+    uint32_t last_batch_bytes;
+    uint32_t last_upload_ms;
+};
+
+// Start the uploader thread. cfg must stay valid.
+int telemetry_init(const struct telemetry_config *cfg);
+
+// Record a sample (value in thousandths, e.g. millidegrees) with the
+// current uptime. Safe to call from any thread or ISR.
+void telemetry_add(uint8_t channel, int32_t value_milli);
+
+// Upload what is waiting now instead of at the next interval
+void telemetry_flush(void);
+
+// Get a snapshot of the counters
+void telemetry_stats_get(struct telemetry_stats *stats);
+
+#endif /* TELEMETRY_H_ */
@@ -0,0 +1,271 @@
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/logging/log.h>
+
+#include "lvgl_port.h"
+#include "ui_service.h"
+
+// Enable logging at CONFIG_LOG_DEFAULT_LEVEL
+LOG_MODULE_REGISTER(ui_service);
+
+// Pending state bits per widget
+#define PENDING_TEXT BIT(0)
+#define PENDING_POS BIT(1)
+
+// Latest update per widget, applied once per frame. Text and number updates
+// share a slot since both end up as the label text.
+struct ui_widget {
+    lv_obj_t *obj;
+    ui_apply_cb_t apply;
+    uint8_t pending;
+    struct ui_msg text;
+    struct ui_msg pos;
+};
+
+//------------------------------------------------------------------------------
+// Forward declarations
+
+static void pending_add(const struct ui_msg *msg);
+static void pending_apply(struct ui_widget *w);
+static void ui_frame(uint32_t frame, void *user_data);
+static void ui_thread_start(void *arg1, void *arg2, void *arg3);
+
+//------------------------------------------------------------------------------
+// Globals
+
+// Producers -> render thread
+K_MSGQ_DEFINE(ui_msgq, sizeof(struct ui_msg), CONFIG_UI_SERVICE_QUEUE_LEN, 4);
+
+// Render thread and the state only it touches
+K_THREAD_STACK_DEFINE(ui_stack, CONFIG_UI_SERVICE_THREAD_STACK_SIZE);
+static struct k_thread ui_thread;
+static K_SEM_DEFINE(ready_sem, 0, 1);
+static struct ui_widget widgets[CONFIG_UI_SERVICE_MAX_WIDGETS];
+static int num_widgets;
+static uint32_t frame_period_ms;
+static ui_setup_cb_t setup_cb;
+static ui_frame_cb_t app_frame_cb;
+static void *app_user_data;
+static int init_ret;
+
+// Counters (posted and dropped are updated by producers)
+static atomic_t posted;
+static atomic_t dropped;
+static uint32_t applied;
+static uint32_t coalesced;
+
+//------------------------------------------------------------------------------
+// Private functions
+
+// Keep only the newest update of each kind per widget
+static void pending_add(const struct ui_msg *msg)
+{
+    struct ui_widget *w;
+
+    if (msg->widget >= num_widgets) {
+        return;
+    }
+    w = &widgets[msg->widget];
+
+    switch (msg->type) {
+    case UI_MSG_TEXT:
+    case UI_MSG_INT:
+        if (w->pending & PENDING_TEXT) {
+            coalesced++;
+        }
+        w->text = *msg;
+        w->pending |= PENDING_TEXT;
+        break;
+    case UI_MSG_POS:
+        if (w->pending & PENDING_POS) {
+            coalesced++;
+        }
+        w->pos = *msg;
+        w->pending |= PENDING_POS;
+        break;
+    default:
+        break;
+    }
+}
+
+// Make the LVGL calls for a widget's pending updates
+static void pending_apply(struct ui_widget *w)
+{
+    char buf[12];
+
+    if (w->pending & PENDING_TEXT) {
+        if (w->apply != NULL) {
+            w->apply(w->obj, &w->text);
+        } else if (w->text.type == UI_MSG_INT) {
+            snprintf(buf, sizeof(buf), "%d", w->text.value);
+            lv_label_set_text(w->obj, buf);
+        } else {
+            lv_label_set_text(w->obj, w->text.text);
+        }
+        applied++;
+    }
+
+    if (w->pending & PENDING_POS) {
+        lv_obj_set_pos(w->obj, w->pos.pos.x, w->pos.pos.y);
+        applied++;
+    }
+
+    w->pending = 0;
+}
+
+// Frame callback from the render loop: drain the queue, then touch each
+// changed widget once
+static void ui_frame(uint32_t frame, void *user_data)
+{
+    struct ui_msg msg;
+
+    while (k_msgq_get(&ui_msgq, &msg, K_NO_WAIT) == 0) {
+        pending_add(&msg);
+    }
+
+    for (int i = 0; i < num_widgets; i++) {
+        if (widgets[i].pending) {
+            pending_apply(&widgets[i]);
+        }
+    }
+
+    if (app_frame_cb != NULL) {
+        app_frame_cb(frame, app_user_data);
+    }
+}
+
+// Render thread: the only thread that calls LVGL
+static void ui_thread_start(void *arg1, void *arg2, void *arg3)
+{
+    init_ret = lvgl_port_init();
+    if ((init_ret == 0) && (setup_cb != NULL)) {
+        setup_cb(app_user_data);
+    }
+    k_sem_give(&ready_sem);
+
+    if (init_ret < 0) {
+        return;
+    }
+
+    lvgl_port_run(frame_period_ms, ui_frame, NULL);
+}
+
+//------------------------------------------------------------------------------
+// Public functions (API)
+
+// Start the render thread and wait until the screen has been built
+int ui_start(uint32_t period_ms,
+             ui_setup_cb_t setup,
+             ui_frame_cb_t frame_cb,
+             void *user_data)
+{
+    frame_period_ms = period_ms;
+    setup_cb = setup;
+    app_frame_cb = frame_cb;
+    app_user_data = user_data;
+
+    k_thread_create(&ui_thread,
+                    ui_stack,
+                    K_THREAD_STACK_SIZEOF(ui_stack),
+                    ui_thread_start,
+                    NULL,
+                    NULL,
+                    NULL,
+                    CONFIG_UI_SERVICE_THREAD_PRIORITY,
+                    0,
+                    K_NO_WAIT);
+    k_thread_name_set(&ui_thread, "ui");
+
+    k_sem_take(&ready_sem, K_FOREVER);
+    if (init_ret < 0) {
+        LOG_ERR("Error (%d): could not start LVGL", init_ret);
+    }
+
+    return init_ret;
+}
+
+// Make a widget addressable by producers, returns its ID
+int ui_widget_add(lv_obj_t *obj)
+{
+    return ui_widget_add_cb(obj, NULL);
+}
+
+// Make a widget with its own text handling addressable, returns its ID
+int ui_widget_add_cb(lv_obj_t *obj, ui_apply_cb_t apply)
+{
+    if (num_widgets >= CONFIG_UI_SERVICE_MAX_WIDGETS) {
+        return -ENOMEM;
+    }
+
+    widgets[num_widgets].obj = obj;
+    widgets[num_widgets].apply = apply;
+    widgets[num_widgets].pending = 0;
+
+    return num_widgets++;
+}
+
+// Queue an update (never blocks)
+int ui_post(const struct ui_msg *msg)
+{
+    if ((msg->widget >= CONFIG_UI_SERVICE_MAX_WIDGETS) ||
+        (msg->type >= UI_MSG_COUNT)) {
+        return -EINVAL;
+    }
+
+    if (k_msgq_put(&ui_msgq, msg, K_NO_WAIT) < 0) {
+        atomic_inc(&dropped);
+        return -EAGAIN;
+    }
+    atomic_inc(&posted);
+
+    return 0;
+}
+
+// Queue a label text update (truncated to CONFIG_UI_SERVICE_TEXT_MAX - 1)
+int ui_post_text(int widget, const char *text)
+{
+    struct ui_msg msg = {
+        .widget = (uint8_t)widget,
+        .type = UI_MSG_TEXT,
+    };
+
+    strncpy(msg.text, text, sizeof(msg.text) - 1);
+
+    return ui_post(&msg);
+}
+
+// Queue a label number update (formatted in the render thread)
+int ui_post_int(int widget, int32_t value)
+{
+    struct ui_msg msg = {
+        .widget = (uint8_t)widget,
+        .type = UI_MSG_INT,
+        .value = value,
+    };
+
+    return ui_post(&msg);
+}
+
+// Queue a position update
+int ui_post_pos(int widget, int16_t x, int16_t y)
+{
+    struct ui_msg msg = {
+        .widget = (uint8_t)widget,
+        .type = UI_MSG_POS,
+        .pos = { .x = x, .y = y },
+    };
+
+    return ui_post(&msg);
+}
+
+// Get a snapshot of the service counters
+void ui_stats_get(struct ui_stats *stats)
+{
+    stats->posted = (uint32_t)atomic_get(&posted);
+    stats->dropped = (uint32_t)atomic_get(&dropped);
+    stats->applied = applied;
+    stats->coalesced = coalesced;
+}
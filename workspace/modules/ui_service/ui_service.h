@@ -0,0 +1,69 @@
+#ifndef UI_SERVICE_H_
+#define UI_SERVICE_H_
+
+#include <stdint.h>
+#include <lvgl.h>
+
+// Builds the screen, runs in the render thread before the first frame
+typedef void (*ui_setup_cb_t)(void *user_data);
+
+// Runs in the render thread once per frame, after queued updates are applied
+typedef void (*ui_frame_cb_t)(uint32_t frame, void *user_data);
+
+struct ui_msg;
+
+// Custom text/number handling for a widget that is not a plain label
+typedef void (*ui_apply_cb_t)(lv_obj_t *obj, const struct ui_msg *msg);
+
+// Update message types
+enum ui_msg_type {
+    UI_MSG_TEXT,    // Set label text
+    UI_MSG_INT,     // Set label text to a decimal number
+    UI_MSG_POS,     // Move the widget (offset from its alignment)
+    UI_MSG_COUNT,
+};
+
+// Update message (copied into the queue)
+struct ui_msg {
+    uint8_t widget;
+    uint8_t type;
+    union {
+        char text[CONFIG_UI_SERVICE_TEXT_MAX];
+        int32_t value;
+        struct {
+            int16_t x;
+            int16_t y;
+        } pos;
+    };
+};
+
+// Service counters
+struct ui_stats {
+    uint32_t posted;        // Updates accepted by the queue
+    uint32_t dropped;       // Updates rejected because the queue was full
+    uint32_t applied;       // LVGL calls made for updates
+    uint32_t coalesced;     // Updates overwritten before they were applied
+};
+
+// Start the render thread (setup and frame_cb are optional)
+int ui_start(uint32_t period_ms,
+             ui_setup_cb_t setup,
+             ui_frame_cb_t frame_cb,
+             void *user_data);
+
+// Make a widget addressable by producers (call from the setup callback)
+int ui_widget_add(lv_obj_t *obj);
+
+// Same, but text and number updates go to apply instead of lv_label_set_text()
+int ui_widget_add_cb(lv_obj_t *obj, ui_apply_cb_t apply);
+
+// Post updates from any thread (never blocks, -EAGAIN if the queue is full)
+int ui_post(const struct ui_msg *msg);
+int ui_post_text(int widget, const char *text);
+int ui_post_int(int widget, int32_t value);
+int ui_post_pos(int widget, int16_t x, int16_t y);
+
+// Get a snapshot of the service counters
+void ui_stats_get(struct ui_stats *stats);
+
+#endif /* UI_SERVICE_H_ */
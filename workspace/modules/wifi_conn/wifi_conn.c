@@ -0,0 +1,471 @@
+#include <errno.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/net/net_if.h>
+#include <zephyr/net/wifi_mgmt.h>
+#include <zephyr/random/random.h>
+#ifdef CONFIG_WIFI_CONN_SETTINGS
+#include <zephyr/settings/settings.h>
+#endif
+
+#include "wifi_conn.h"
+
+// Enable logging at CONFIG_LOG_DEFAULT_LEVEL
+LOG_MODULE_REGISTER(wifi_conn);
+
+// Connection state. Once started, the link is kept up: a failed attempt
+// waits out a backoff and a dropped link reconnects straight away.
+enum wifi_link_state {
+    WIFI_LINK_IDLE,
+    WIFI_LINK_CONNECTING,
+    WIFI_LINK_WAIT_IP,
+    WIFI_LINK_UP,
+    WIFI_LINK_BACKOFF,
+};
+
+// Events from the network management callbacks
+#define EVT_CONNECTED BIT(0)
+#define EVT_CONNECT_FAILED BIT(1)
+#define EVT_DISCONNECTED BIT(2)
+#define EVT_IPV4 BIT(3)
+
+// The access point from the last good connection
+struct wifi_ap_cache {
+    uint8_t ssid[WIFI_SSID_MAX_LEN];
+    uint8_t ssid_len;
+    uint8_t bssid[WIFI_MAC_ADDR_LEN];
+    uint8_t channel;
+    uint8_t band;
+};
+
+//------------------------------------------------------------------------------
+// Forward declarations
+
+static void on_wifi_connection_event(struct net_mgmt_event_callback *cb,
+                                     uint32_t mgmt_event,
+                                     struct net_if *iface);
+static void on_ipv4_obtained(struct net_mgmt_event_callback *cb,
+                             uint32_t mgmt_event,
+                             struct net_if *iface);
+static bool cache_usable(void);
+static void cache_update(void);
+static void set_state(enum wifi_link_state new_state, int32_t timeout_ms);
+static void start_attempt(void);
+static void attempt_failed(int err);
+static void enter_connected(void);
+static void wifi_work_handler(struct k_work *work);
+
+//------------------------------------------------------------------------------
+// Globals
+
+// Event callbacks
+static struct net_mgmt_event_callback wifi_cb;
+static struct net_mgmt_event_callback ipv4_cb;
+
+// Network to join (copied, so the caller's strings need not stay around)
+static char wifi_ssid[WIFI_SSID_MAX_LEN + 1];
+static char wifi_psk[WIFI_PSK_MAX_LEN + 1];
+
+// State machine, run on the system workqueue. The callbacks only post
+// events, every transition happens in wifi_work_handler().
+static K_WORK_DELAYABLE_DEFINE(wifi_work, wifi_work_handler);
+static atomic_t pending_events;
+static enum wifi_link_state state = WIFI_LINK_IDLE;
+static int64_t deadline;
+static int64_t down_since;
+static uint32_t backoff_ms;
+static bool attempt_fast;
+static bool fast_failed;
+
+// Given each time the link comes up (with an IP address)
+static K_SEM_DEFINE(sem_up, 0, 1);
+
+// Last good access point (loaded from flash at boot with WIFI_CONN_SETTINGS)
+static struct wifi_ap_cache ap_cache;
+static bool ap_cache_valid;
+
+// Counters
+static struct wifi_conn_stats stats;
+
+//------------------------------------------------------------------------------
+// Private functions
+
+// Called when the WiFi is connected or disconnected
+static void on_wifi_connection_event(struct net_mgmt_event_callback *cb,
+                                     uint32_t mgmt_event,
+                                     struct net_if *iface)
+{
+    const struct wifi_status *status = (const struct wifi_status *)cb->info;
+
+    if (mgmt_event == NET_EVENT_WIFI_CONNECT_RESULT) {
+        atomic_or(&pending_events, status->status ? EVT_CONNECT_FAILED : EVT_CONNECTED);
+    } else if (mgmt_event == NET_EVENT_WIFI_DISCONNECT_RESULT) {
+        atomic_or(&pending_events, EVT_DISCONNECTED);
+    } else {
+        return;
+    }
+    k_work_reschedule(&wifi_work, K_NO_WAIT);
+}
+
+// Called when DHCP has provided an IPv4 address
+static void on_ipv4_obtained(struct net_mgmt_event_callback *cb,
+                             uint32_t mgmt_event,
+                             struct net_if *iface)
+{
+    atomic_or(&pending_events, EVT_IPV4);
+    k_work_reschedule(&wifi_work, K_NO_WAIT);
+}
+
+#ifdef CONFIG_WIFI_CONN_SETTINGS
+// Load "wifi/ap" from flash
+static int wifi_settings_set(const char *name,
+                             size_t len,
+                             settings_read_cb read_cb,
+                             void *cb_arg)
+{
+    if (strcmp(name, "ap") != 0) {
+        return -ENOENT;
+    }
+    if (len != sizeof(ap_cache)) {
+        return -EINVAL;
+    }
+    if (read_cb(cb_arg, &ap_cache, sizeof(ap_cache)) == sizeof(ap_cache)) {
+        ap_cache_valid = true;
+    }
+
+    return 0;
+}
+
+SETTINGS_STATIC_HANDLER_DEFINE(wifi, "wifi", NULL, wifi_settings_set, NULL, NULL);
+#endif
+
+// The cache is only worth trying for the same network, and not straight
+// after it failed (the AP may have moved channel or been replaced)
+static bool cache_usable(void)
+{
+    return ap_cache_valid &&
+           !fast_failed &&
+           (ap_cache.ssid_len == strlen(wifi_ssid)) &&
+           (memcmp(ap_cache.ssid, wifi_ssid, ap_cache.ssid_len) == 0);
+}
+
+// Remember the AP we just joined, writing to flash only if it changed
+static void cache_update(void)
+{
+    struct wifi_iface_status status;
+    struct wifi_ap_cache fresh;
+
+    memset(&status, 0, sizeof(status));
+    if (net_mgmt(NET_REQUEST_WIFI_IFACE_STATUS,
+                 net_if_get_default(),
+                 &status,
+                 sizeof(status))) {
+        LOG_ERR("Error: WiFi status request failed");
+        return;
+    }
+
+    memset(&fresh, 0, sizeof(fresh));
+    fresh.ssid_len = MIN(status.ssid_len, sizeof(fresh.ssid));
+    memcpy(fresh.ssid, status.ssid, fresh.ssid_len);
+    memcpy(fresh.bssid, status.bssid, sizeof(fresh.bssid));
+    fresh.channel = status.channel;
+    fresh.band = status.band;
+
+    if (ap_cache_valid && (memcmp(&fresh, &ap_cache, sizeof(fresh)) == 0)) {
+        return;
+    }
+    ap_cache = fresh;
+    ap_cache_valid = true;
+
+#ifdef CONFIG_WIFI_CONN_SETTINGS
+    int ret = settings_save_one("wifi/ap", &ap_cache, sizeof(ap_cache));
+
+    if (ret < 0) {
+        LOG_ERR("Error (%d): could not save access point", ret);
+    }
+#endif
+}
+
+// Move to a new state, giving it timeout_ms to finish (-1 for no limit)
+static void set_state(enum wifi_link_state new_state, int32_t timeout_ms)
+{
+    state = new_state;
+    if (timeout_ms >= 0) {
+        deadline = k_uptime_get() + timeout_ms;
+        k_work_reschedule(&wifi_work, K_MSEC(timeout_ms));
+    }
+}
+
+// Ask the driver to connect, aimed at the cached AP when there is one
+static void start_attempt(void)
+{
+    struct wifi_connect_req_params params;
+    int ret;
+
+    memset(&params, 0, sizeof(params));
+    params.ssid = (const uint8_t *)wifi_ssid;
+    params.ssid_length = strlen(wifi_ssid);
+    params.psk = (const uint8_t *)wifi_psk;
+    params.psk_length = strlen(wifi_psk);
+    params.security = WIFI_SECURITY_TYPE_PSK;
+    params.mfp = WIFI_MFP_OPTIONAL;
+    params.timeout = SYS_FOREVER_MS;
+
+    // Skip the scan if we know where the AP is. Drivers that ignore the
+    // hint still scan, so this is never slower than the plain request.
+    attempt_fast = cache_usable();
+    if (attempt_fast) {
+        memcpy(params.bssid, ap_cache.bssid, sizeof(params.bssid));
+        params.band = ap_cache.band;
+        params.channel = ap_cache.channel;
+        stats.fast_attempts++;
+    } else {
+        params.band = WIFI_FREQ_BAND_UNKNOWN;
+        params.channel = WIFI_CHANNEL_ANY;
+    }
+    stats.attempts++;
+
+    set_state(WIFI_LINK_CONNECTING,
+              attempt_fast ? CONFIG_WIFI_CONN_FAST_TIMEOUT_MS : CONFIG_WIFI_CONN_SCAN_TIMEOUT_MS);
+    ret = net_mgmt(NET_REQUEST_WIFI_CONNECT,
+                   net_if_get_default(),
+                   &params,
+                   sizeof(params));
+    if (ret < 0) {
+        attempt_failed(ret);
+    }
+}
+
+// Give up on this attempt and try again after the backoff
+static void attempt_failed(int err)
+{
+    // Make sure the driver is not still working on it
+    if (err == -ETIMEDOUT) {
+        net_mgmt(NET_REQUEST_WIFI_DISCONNECT, net_if_get_default(), NULL, 0);
+    }
+    stats.failures++;
+
+    // The AP may have moved: scan for it now rather than after a backoff
+    if (attempt_fast) {
+        LOG_WRN("Attempt failed (%d) on cached AP, scanning", err);
+        fast_failed = true;
+        set_state(WIFI_LINK_BACKOFF, 0);
+        return;
+    }
+
+    LOG_WRN("Attempt failed (%d), retrying in %u ms", err, backoff_ms);
+    set_state(WIFI_LINK_BACKOFF, backoff_ms + (sys_rand32_get() % (backoff_ms / 4 + 1)));
+    backoff_ms = MIN(backoff_ms * 2, CONFIG_WIFI_CONN_BACKOFF_MAX_MS);
+}
+
+// Link and address are up
+static void enter_connected(void)
+{
+    stats.last_up_ms = (uint32_t)(k_uptime_get() - down_since);
+    stats.last_fast = attempt_fast;
+    fast_failed = false;
+    backoff_ms = CONFIG_WIFI_CONN_BACKOFF_MIN_MS;
+    set_state(WIFI_LINK_UP, -1);
+    cache_update();
+    k_sem_give(&sem_up);
+}
+
+// Run the state machine on new events or an expired deadline
+static void wifi_work_handler(struct k_work *work)
+{
+    atomic_val_t events = atomic_clear(&pending_events);
+    bool expired = (k_uptime_get() >= deadline);
+    struct net_if *iface = net_if_get_default();
+
+    switch (state) {
+    case WIFI_LINK_CONNECTING:
+        if (events & EVT_CONNECTED) {
+            set_state(WIFI_LINK_WAIT_IP, CONFIG_WIFI_CONN_DHCP_TIMEOUT_MS);
+
+            // DHCP may already have the address from before the drop
+            if (net_if_ipv4_get_global_addr(iface, NET_ADDR_PREFERRED) != NULL) {
+                enter_connected();
+            }
+        } else if (events & (EVT_CONNECT_FAILED | EVT_DISCONNECTED)) {
+            attempt_failed(-ECONNREFUSED);
+        } else if (expired) {
+            attempt_failed(-ETIMEDOUT);
+        }
+        break;
+
+    case WIFI_LINK_WAIT_IP:
+        if (events & EVT_DISCONNECTED) {
+            attempt_failed(-ECONNRESET);
+        } else if ((events & EVT_IPV4) ||
+                   (net_if_ipv4_get_global_addr(iface, NET_ADDR_PREFERRED) != NULL)) {
+            enter_connected();
+        } else if (expired) {
+            attempt_failed(-ETIMEDOUT);
+        }
+        break;
+
+    case WIFI_LINK_UP:
+
+        // Lost the link: go straight back to the same AP
+        if (events & EVT_DISCONNECTED) {
+            LOG_WRN("Link lost, reconnecting");
+            stats.drops++;
+            down_since = k_uptime_get();
+            k_sem_take(&sem_up, K_NO_WAIT);
+            start_attempt();
+        }
+        break;
+
+    case WIFI_LINK_BACKOFF:
+        if (expired) {
+            start_attempt();
+        }
+        break;
+
+    default:
+        break;
+    }
+
+    // Events run the work straight away, so put the deadline back
+    if ((state != WIFI_LINK_IDLE) && (state != WIFI_LINK_UP)) {
+        k_work_schedule(&wifi_work, K_TIMEOUT_ABS_MS(deadline));
+    }
+}
+
+//------------------------------------------------------------------------------
+// Public functions (API)
+
+// Initialize the WiFi event callbacks and load the cached access point
+void wifi_conn_init(void)
+{
+    // Initialize the event callbacks
+    net_mgmt_init_event_callback(&wifi_cb,
+                                 on_wifi_connection_event,
+                                 NET_EVENT_WIFI_CONNECT_RESULT | NET_EVENT_WIFI_DISCONNECT_RESULT);
+    net_mgmt_init_event_callback(&ipv4_cb,
+                                 on_ipv4_obtained,
+                                 NET_EVENT_IPV4_ADDR_ADD | NET_EVENT_IPV4_DHCP_BOUND);
+
+    // Add the event callbacks
+    net_mgmt_add_event_callback(&wifi_cb);
+    net_mgmt_add_event_callback(&ipv4_cb);
+
+#ifdef CONFIG_WIFI_CONN_SETTINGS
+    if ((settings_subsys_init() == 0) && (settings_load_subtree("wifi") == 0) && ap_cache_valid) {
+        LOG_INF("Cached AP on channel %u", ap_cache.channel);
+    }
+#endif
+}
+
+// Start connecting to the WiFi network (returns straight away)
+int wifi_conn_connect(const char *ssid, const char *psk)
+{
+    if ((strlen(ssid) > WIFI_SSID_MAX_LEN) || (strlen(psk) > WIFI_PSK_MAX_LEN)) {
+        return -EINVAL;
+    }
+    if (state != WIFI_LINK_IDLE) {
+        return -EALREADY;
+    }
+
+    strcpy(wifi_ssid, ssid);
+    strcpy(wifi_psk, psk);
+    backoff_ms = CONFIG_WIFI_CONN_BACKOFF_MIN_MS;
+    fast_failed = false;
+    down_since = k_uptime_get();
+    k_work_cancel_delayable(&wifi_work);
+    start_attempt();
+
+    return 0;
+}
+
+// Wait until the link is up with an IP address, then print the status
+int wifi_conn_wait_for_ip_addr(k_timeout_t timeout)
+{
+    k_timepoint_t end = sys_timepoint_calc(timeout);
+    struct wifi_iface_status status;
+    struct net_if *iface;
+    char ip_addr[NET_IPV4_ADDR_LEN];
+    char gw_addr[NET_IPV4_ADDR_LEN];
+
+    // Get interface
+    iface = net_if_get_default();
+
+    // Wait for the IPv4 address to be obtained
+    while (state != WIFI_LINK_UP) {
+        if (k_sem_take(&sem_up, sys_timepoint_timeout(end)) < 0) {
+            return -ETIMEDOUT;
+        }
+    }
+
+    // Get the WiFi status
+    memset(&status, 0, sizeof(status));
+    if (net_mgmt(NET_REQUEST_WIFI_IFACE_STATUS,
+                 iface,
+                 &status,
+                 sizeof(struct wifi_iface_status))) {
+        printk("Error: WiFi status request failed\r\n");
+    }
+
+    // Get the IP address
+    memset(ip_addr, 0, sizeof(ip_addr));
+    if (net_addr_ntop(AF_INET,
+                      &iface->config.ip.ipv4->unicast[0].ipv4.address.in_addr,
+                      ip_addr,
+                      sizeof(ip_addr)) == NULL) {
+        printk("Error: Could not convert IP address to string\r\n");
+    }
+
+    // Get the gateway address
+    memset(gw_addr, 0, sizeof(gw_addr));
+    if (net_addr_ntop(AF_INET,
+                      &iface->config.ip.ipv4->gw,
+                      gw_addr,
+                      sizeof(gw_addr)) == NULL) {
+        printk("Error: Could not convert gateway address to string\r\n");
+    }
+
+    // Print the WiFi status
+    printk("WiFi status:\r\n");
+    if (status.state >= WIFI_STATE_ASSOCIATED) {
+        printk("  SSID: %-32s\r\n", status.ssid);
+        printk("  Band: %s\r\n", wifi_band_txt(status.band));
+        printk("  Channel: %d\r\n", status.channel);
+        printk("  Security: %s\r\n", wifi_security_txt(status.security));
+        printk("  RSSI: %d\r\n", status.rssi);
+        printk("  IP address: %s\r\n", ip_addr);
+        printk("  Gateway: %s\r\n", gw_addr);
+    }
+    printk("  Connected in %u ms (%s)\r\n",
+           stats.last_up_ms,
+           stats.last_fast ? "cached AP" : "full scan");
+
+    return 0;
+}
+
+// True while the link is up with an IP address
+bool wifi_conn_is_connected(void)
+{
+    return state == WIFI_LINK_UP;
+}
+
+// Stop the state machine and disconnect from the WiFi network
+int wifi_conn_disconnect(void)
+{
+    int ret;
+    struct net_if *iface = net_if_get_default();
+
+    k_work_cancel_delayable(&wifi_work);
+    state = WIFI_LINK_IDLE;
+    k_sem_take(&sem_up, K_NO_WAIT);
+
+    ret = net_mgmt(NET_REQUEST_WIFI_DISCONNECT, iface, NULL, 0);
+
+    return ret;
+}
+
+// Get a snapshot of the counters
+void wifi_conn_stats_get(struct wifi_conn_stats *stats_out)
+{
+    *stats_out = stats;
+}
@@ -0,0 +1,40 @@
+#ifndef WIFI_CONN_H_
+#define WIFI_CONN_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <zephyr/kernel.h>
+
+// Connection counters
+struct wifi_conn_stats {
+    uint32_t attempts;      // Connect requests
+    uint32_t fast_attempts; // Requests aimed at the cached BSSID and channel
+    uint32_t failures;      // Attempts that failed or timed out
+    uint32_t drops;         // Links lost after coming up
+    uint32_t last_up_ms;    // Start (or link loss) to IP address, last time
+    bool last_fast;         // Last link came up on the cached AP
+};
+
+// Register the network event callbacks and load the cached access point
+// (from flash with WIFI_CONN_SETTINGS). Call once before anything else.
+void wifi_conn_init(void);
+
+// Start connecting to the network and return straight away. From then on
+// the link is kept up: a failed attempt waits out a backoff and a dropped
+// link reconnects straight away. Returns -EALREADY if already started.
+int wifi_conn_connect(const char *ssid, const char *psk);
+
+// Wait until the link is up with an IP address, then print the status.
+// Returns -ETIMEDOUT if it did not come up in time.
+int wifi_conn_wait_for_ip_addr(k_timeout_t timeout);
+
+// True while the link is up with an IP address
+bool wifi_conn_is_connected(void);
+
+// Stop reconnecting and disconnect from the network
+int wifi_conn_disconnect(void);
+
+// Get a snapshot of the counters
+void wifi_conn_stats_get(struct wifi_conn_stats *stats);
+
+#endif /* WIFI_CONN_H_ */